@@ -0,0 +1,202 @@
+#include "wsclient.h"
+
+#include <algorithm>
+#include <iostream>
+#include <string>
+#include <sys/epoll.h>
+#include <vector>
+
+namespace {
+struct Options {
+    std::string host = "127.0.0.1";
+    std::uint16_t port = 3480;
+    std::size_t pairs = 20;
+    std::size_t calls = 50;
+    std::size_t candidates = 20;
+    std::int64_t gapUs = 200;
+    std::string mode = "both";
+};
+
+struct Peer {
+    int fd = -1;
+    wsbench::FrameReader reader;
+};
+
+struct Pair {
+    Peer sender;
+    Peer receiver;
+    std::string senderId;
+    std::string receiverId;
+    std::size_t call = 0;
+    std::size_t sent = 0;
+    std::size_t received = 0;
+    std::int64_t callStartNs = 0;
+    std::int64_t nextSendNs = 0;
+    bool done = false;
+};
+
+struct PhaseResult {
+    std::size_t frames = 0;
+    std::size_t candidates = 0;
+    double seconds = 0;
+    std::vector<std::int64_t> setups;
+};
+
+bool openPeer(const Options& options, const std::string& sessionId, bool batch, Peer& peer)
+{
+    peer.fd = wsbench::connectTcp(options.host, options.port);
+    if (peer.fd == -1) return false;
+    std::string leftover;
+    const auto resource = "/?sessionId=" + sessionId + "&hostname=bench" + (batch ? "&batchCandidates=1" : "");
+    if (!wsbench::handshake(peer.fd, options.host, options.port, resource, leftover)) return false;
+    peer.reader.append(leftover.data(), leftover.size());
+    wsbench::setNonBlocking(peer.fd);
+    return true;
+}
+
+std::size_t countOccurrences(const std::string& text, const std::string& needle)
+{
+    std::size_t count = 0;
+    for (auto position = text.find(needle); position != std::string::npos; position = text.find(needle, position + needle.size())) ++count;
+    return count;
+}
+
+bool runPhase(const Options& options, bool batch, PhaseResult& result)
+{
+    const std::string tag = batch ? "on" : "off";
+    std::vector<Pair> pairs(options.pairs);
+    const int epollFd = epoll_create1(0);
+    for (std::size_t i = 0; i < pairs.size(); ++i) {
+        auto& pair = pairs[i];
+        pair.senderId = "cand-" + tag + "-s-" + std::to_string(i);
+        pair.receiverId = "cand-" + tag + "-r-" + std::to_string(i);
+        if (!openPeer(options, pair.senderId, batch, pair.sender) || !openPeer(options, pair.receiverId, batch, pair.receiver)) {
+            std::cerr << "pair " << i << " failed to connect\n";
+            return false;
+        }
+        epoll_event event{};
+        event.events = EPOLLIN;
+        event.data.u64 = i;
+        epoll_ctl(epollFd, EPOLL_CTL_ADD, pair.receiver.fd, &event);
+    }
+
+    const std::string padding = "candidate:842163049 1 udp 1677729535 203.0.113.7 50123 typ srflx raddr 10.0.0.7 rport 50123 generation 0 ufrag x9Zq";
+    const auto begin = wsbench::nowNs();
+    for (auto& pair : pairs) pair.nextSendNs = begin;
+    std::size_t finished = 0;
+    epoll_event events[128];
+    char buffer[65536];
+    std::string payload;
+    std::uint8_t opcode = 0;
+    while (finished < pairs.size()) {
+        auto now = wsbench::nowNs();
+        std::int64_t nextDue = now + 1000000000;
+        for (auto& pair : pairs) {
+            while (!pair.done && pair.sent < options.candidates && pair.nextSendNs <= now) {
+                if (pair.sent == 0) pair.callStartNs = now;
+                const auto message = "{\"type\":\"candidate\",\"sender\":\"" + pair.senderId + "\",\"receiver\":\"" + pair.receiverId
+                    + "\",\"data\":{\"call\":" + std::to_string(pair.call) + ",\"candidate\":\"" + padding + "\"}}";
+                const auto frame = wsbench::encodeFrame(message);
+                wsbench::sendAll(pair.sender.fd, frame.data(), frame.size());
+                ++pair.sent;
+                pair.nextSendNs += options.gapUs * 1000;
+            }
+            if (!pair.done && pair.sent < options.candidates) nextDue = std::min(nextDue, pair.nextSendNs);
+        }
+        const auto timeoutMs = static_cast<int>(std::max<std::int64_t>(0, (nextDue - now) / 1000000));
+        const int count = epoll_wait(epollFd, events, 128, std::min(timeoutMs, 5000));
+        if (count < 0) break;
+        if (count == 0 && nextDue - now > 1000000000) {
+            std::cerr << "timed out waiting for candidates\n";
+            break;
+        }
+        for (int e = 0; e < count; ++e) {
+            auto& pair = pairs[events[e].data.u64];
+            while (true) {
+                const auto received = recv(pair.receiver.fd, buffer, sizeof(buffer), 0);
+                if (received <= 0) break;
+                pair.receiver.reader.append(buffer, static_cast<std::size_t>(received));
+            }
+            while (pair.receiver.reader.next(payload, opcode)) {
+                if (opcode != 0x1 || payload.find("\"sender\":\"server\"") != std::string::npos) continue;
+                ++result.frames;
+                const auto candidates = countOccurrences(payload, "\"candidate\":\"");
+                result.candidates += candidates;
+                pair.received += candidates;
+            }
+            if (pair.done || pair.received < options.candidates) continue;
+            now = wsbench::nowNs();
+            result.setups.push_back(now - pair.callStartNs);
+            pair.received = 0;
+            pair.sent = 0;
+            pair.nextSendNs = now;
+            if (++pair.call == options.calls) {
+                pair.done = true;
+                ++finished;
+            }
+        }
+    }
+    result.seconds = static_cast<double>(wsbench::nowNs() - begin) / 1e9;
+    close(epollFd);
+    for (auto& pair : pairs) {
+        close(pair.sender.fd);
+        close(pair.receiver.fd);
+    }
+    return finished == pairs.size();
+}
+
+void report(const char* label, PhaseResult& result, const Options& options)
+{
+    std::sort(result.setups.begin(), result.setups.end());
+    const auto percentile = [&result](double p) {
+        return result.setups.empty() ? 0.0 : static_cast<double>(result.setups[static_cast<std::size_t>(p * (result.setups.size() - 1))]) / 1000.0;
+    };
+    const auto calls = static_cast<double>(std::max<std::size_t>(1, result.setups.size()));
+    std::cout << label << '\n'
+              << "  calls:                " << result.setups.size() << " / " << options.pairs * options.calls << '\n'
+              << "  candidates received:  " << result.candidates << '\n'
+              << "  frames received:      " << result.frames << " (" << static_cast<double>(result.frames) / calls << " per call)\n"
+              << "  frames/sec:           " << static_cast<double>(result.frames) / result.seconds << '\n'
+              << "  candidates/sec:       " << static_cast<double>(result.candidates) / result.seconds << '\n'
+              << "  setup p50/p99:        " << percentile(0.5) << " / " << percentile(0.99) << " us\n";
+}
+
+void printUsage()
+{
+    std::cout << "candidate_bench [--host H] [--port P] [--pairs N] [--calls N] [--candidates N] [--gap-us N] [--mode off|on|both]\n"
+                 "  Start the server with [candidate_batch] enabled=true; mode selects whether receivers opt in.\n";
+}
+}
+
+int main(int argc, char* argv[])
+{
+    Options options;
+    for (int i = 1; i + 1 < argc; i += 2) {
+        const std::string key = argv[i];
+        const std::string value = argv[i + 1];
+        if (key == "--host") options.host = value;
+        else if (key == "--port") options.port = static_cast<std::uint16_t>(std::stoul(value));
+        else if (key == "--pairs") options.pairs = std::max<std::size_t>(1, std::stoul(value));
+        else if (key == "--calls") options.calls = std::max<std::size_t>(1, std::stoul(value));
+        else if (key == "--candidates") options.candidates = std::max<std::size_t>(1, std::stoul(value));
+        else if (key == "--gap-us") options.gapUs = std::stoll(value);
+        else if (key == "--mode") options.mode = value;
+        else {
+            printUsage();
+            return 1;
+        }
+    }
+
+    bool ok = true;
+    if (options.mode == "off" || options.mode == "both") {
+        PhaseResult result;
+        ok = runPhase(options, false, result) && ok;
+        report("unbatched receivers", result, options);
+    }
+    if (options.mode == "on" || options.mode == "both") {
+        PhaseResult result;
+        ok = runPhase(options, true, result) && ok;
+        report("batched receivers", result, options);
+    }
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,150 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <mutex>
+#include <nlohmann/json.hpp>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace {
+using Clock = std::chrono::steady_clock;
+
+struct Result {
+    double queriesPerSecond = 0;
+    double writesPerSecond = 0;
+    double writeMaxUs = 0;
+};
+
+// Runs `readers` threads issuing batch queries and one writer churning status
+// for `seconds`, returning aggregate rates.
+template <typename Query, typename Write>
+Result run(unsigned readers, bool withWriter, double seconds, Query&& query, Write&& write)
+{
+    std::atomic_bool running{true};
+    std::atomic<std::uint64_t> queries{0};
+    std::atomic<std::uint64_t> writes{0};
+    std::int64_t writeMaxNs = 0;
+    std::vector<std::thread> threads;
+    for (unsigned r = 0; r < readers; ++r) {
+        threads.emplace_back([&] {
+            std::uint64_t local = 0;
+            while (running.load(std::memory_order_relaxed)) {
+                query();
+                ++local;
+            }
+            queries += local;
+        });
+    }
+    if (withWriter) {
+        threads.emplace_back([&] {
+            std::uint64_t local = 0;
+            while (running.load(std::memory_order_relaxed)) {
+                const auto begin = Clock::now();
+                write(local++);
+                writeMaxNs = std::max<std::int64_t>(writeMaxNs, std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - begin).count());
+            }
+            writes += local;
+        });
+    }
+    std::this_thread::sleep_for(std::chrono::duration<double>(seconds));
+    running = false;
+    for (auto& thread : threads) thread.join();
+    return {static_cast<double>(queries) / seconds, static_cast<double>(writes) / seconds, static_cast<double>(writeMaxNs) / 1e3};
+}
+
+struct Presence {
+    bool online = false;
+    std::string loginDate;
+};
+
+// Same layout as UserManager: one mutex around the user map, held for the
+// whole query.
+class PresenceMap {
+public:
+    void update(const std::string& sn, bool online, const std::string& loginDate)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_users[sn] = {online, loginDate};
+    }
+
+    std::vector<std::pair<std::string, Presence>> lookup(const std::vector<std::string>& sns) const
+    {
+        std::vector<std::pair<std::string, Presence>> result(sns.size());
+        std::lock_guard<std::mutex> lock(m_mutex);
+        for (std::size_t i = 0; i < sns.size(); ++i) {
+            result[i].first = sns[i];
+            const auto it = m_users.find(sns[i]);
+            if (it != m_users.end()) result[i].second = it->second;
+        }
+        return result;
+    }
+
+private:
+    mutable std::mutex m_mutex;
+    std::unordered_map<std::string, Presence> m_users;
+};
+}
+
+int main(int argc, char* argv[])
+{
+    const std::size_t users = argc > 1 ? std::stoul(argv[1]) : 50000;
+    const std::size_t batch = argc > 2 ? std::stoul(argv[2]) : 1000;
+    const unsigned readers = argc > 3 ? static_cast<unsigned>(std::stoul(argv[3])) : 2;
+    const double seconds = 2.0;
+    const std::string loginDate = "2024-01-01T00:00:00Z";
+
+    std::vector<std::string> sns(users);
+    PresenceMap map;
+    for (std::size_t i = 0; i < users; ++i) {
+        sns[i] = "device-" + std::to_string(i);
+        map.update(sns[i], i % 2 == 0, loginDate);
+    }
+    std::vector<std::string> query;
+    for (std::size_t i = 0; i < batch; ++i) query.push_back(sns[(i * 7919) % users]);
+
+    std::atomic<std::uint64_t> online{0};
+    const auto mapQuery = [&] {
+        std::uint64_t count = 0;
+        for (const auto& entry : map.lookup(query)) count += entry.second.online;
+        online.fetch_add(count, std::memory_order_relaxed);
+    };
+    const auto mapWrite = [&](std::uint64_t i) { map.update(sns[i % users], i % 3 != 0, loginDate); };
+
+    const auto idle = run(readers, false, seconds, mapQuery, mapWrite);
+    const auto busy = run(readers, true, seconds, mapQuery, mapWrite);
+    const auto writerAlone = run(0, true, seconds, mapQuery, mapWrite);
+
+    const auto begin = Clock::now();
+    std::size_t replyBytes = 0;
+    const int replies = 200;
+    for (int r = 0; r < replies; ++r) {
+        auto presence = map.lookup(query);
+        nlohmann::json result = nlohmann::json::array();
+        result.get_ref<nlohmann::json::array_t&>().reserve(presence.size());
+        for (auto& entry : presence) {
+            nlohmann::json item(nlohmann::json::value_t::object);
+            item["sn"] = std::move(entry.first);
+            item["online"] = entry.second.online;
+            item["loginDate"] = std::move(entry.second.loginDate);
+            result.push_back(std::move(item));
+        }
+        nlohmann::json response = {{"type", "presenceResult"}, {"sender", "server"}, {"receiver", "bench"}};
+        response["data"] = std::move(result);
+        replyBytes = response.dump().size();
+    }
+    const auto replySeconds = std::chrono::duration<double>(Clock::now() - begin).count() / replies;
+
+    std::cout << "users / batch / readers:        " << users << " / " << batch << " / " << readers << '\n'
+              << "queries, no writer:             " << idle.queriesPerSecond << " queries/s ("
+              << idle.queriesPerSecond * batch / 1e6 << " M SN/s)\n"
+              << "queries, writer churning:       " << busy.queriesPerSecond << " queries/s, writer "
+              << busy.writesPerSecond << " updates/s, slowest update " << busy.writeMaxUs << " us\n"
+              << "writer, no readers:             " << writerAlone.writesPerSecond << " updates/s\n"
+              << "lookup + JSON reply:            " << replySeconds * 1e3 << " ms/query (" << replyBytes << " bytes)\n"
+              << "online seen:                    " << online << '\n';
+    return 0;
+}
@@ -0,0 +1,51 @@
+#include "ratelimiter.h"
+
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+
+namespace {
+// Results go to a volatile sink and buckets are reached through volatile
+// pointers, so the compiler can neither drop the loop nor hoist the
+// m_rate check out of it.
+volatile std::uint64_t sink = 0;
+
+template <typename Function>
+double nanosecondsPerCall(std::uint64_t iterations, Function&& function)
+{
+    const auto begin = std::chrono::steady_clock::now();
+    for (std::uint64_t i = 0; i < iterations; ++i) function(i);
+    const auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - begin).count();
+    return static_cast<double>(elapsed) / static_cast<double>(iterations);
+}
+}
+
+int main(int argc, char* argv[])
+{
+    const std::uint64_t iterations = argc > 1 ? std::stoull(argv[1]) : 50000000ULL;
+
+    const auto loopNs = nanosecondsPerCall(iterations, [&](std::uint64_t i) { sink = sink + (i & 1); });
+
+    TokenBucket disabledBucket;
+    TokenBucket* volatile disabled = &disabledBucket;
+    const auto disabledNs = nanosecondsPerCall(iterations, [&](std::uint64_t) { sink = sink + disabled->tryConsume(); });
+
+    TokenBucket limitedBucket(100, 200);
+    TokenBucket* volatile limited = &limitedBucket;
+    const auto clockNs = nanosecondsPerCall(iterations, [&](std::uint64_t) { sink = sink + limited->tryConsume(); });
+
+    TokenBucket fixedClockBucket(1e6, 200);
+    TokenBucket* volatile fixedClock = &fixedClockBucket;
+    const auto base = TokenBucket::Clock::now();
+    const auto arithmeticNs = nanosecondsPerCall(iterations, [&](std::uint64_t i) {
+        sink = sink + fixedClock->tryConsume(base + std::chrono::nanoseconds(i));
+    });
+
+    std::cout << "iterations:            " << iterations << '\n'
+              << "empty loop (baseline): " << loopNs << " ns/iteration\n"
+              << "disabled bucket:       " << disabledNs << " ns/check\n"
+              << "enabled, steady_clock: " << clockNs << " ns/check\n"
+              << "enabled, given time:   " << arithmeticNs << " ns/check\n"
+              << "sink:                  " << sink << '\n';
+    return 0;
+}
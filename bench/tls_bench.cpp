@@ -0,0 +1,261 @@
+#include "wsclient.h"
+
+#include <algorithm>
+#include <csignal>
+#include <iostream>
+#include <openssl/err.h>
+#include <openssl/ssl.h>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+struct Options {
+    std::string host = "127.0.0.1";
+    std::uint16_t port = 8443;
+    std::uint16_t plainPort = 3480;
+    std::size_t connections = 2000;
+    std::size_t threads = 4;
+    std::size_t pairs = 8;
+    std::size_t messages = 20000;
+    std::size_t size = 256;
+    std::size_t window = 16;
+    std::string mode = "all";
+};
+
+// Blocking WebSocket client over plain TCP or, when given an SSL_CTX, TLS.
+class Connection {
+public:
+    ~Connection() { shutdown(); }
+
+    bool open(const Options& options, std::uint16_t port, SSL_CTX* context, SSL_SESSION* session, const std::string& sessionId,
+        std::int64_t* tlsDoneNs = nullptr)
+    {
+        m_fd = wsbench::connectTcp(options.host, port);
+        if (m_fd == -1) return false;
+        if (context) {
+            m_ssl = SSL_new(context);
+            SSL_set_fd(m_ssl, m_fd);
+            if (session) SSL_set_session(m_ssl, session);
+            if (SSL_connect(m_ssl) != 1) return false;
+            if (tlsDoneNs) *tlsDoneNs = wsbench::nowNs();
+        }
+        const auto request = wsbench::handshakeRequest(options.host, port, "/?sessionId=" + sessionId + "&hostname=bench");
+        if (!write(request)) return false;
+        std::string response;
+        char buffer[4096];
+        while (response.find("\r\n\r\n") == std::string::npos) {
+            const auto received = readSome(buffer, sizeof(buffer));
+            if (received <= 0) return false;
+            response.append(buffer, static_cast<std::size_t>(received));
+        }
+        const auto end = response.find("\r\n\r\n") + 4;
+        m_reader.append(response.data() + end, response.size() - end);
+        return response.compare(0, 12, "HTTP/1.1 101") == 0;
+    }
+
+    bool write(const std::string& data)
+    {
+        if (!m_ssl) return wsbench::sendAll(m_fd, data.data(), data.size());
+        return SSL_write(m_ssl, data.data(), static_cast<int>(data.size())) == static_cast<int>(data.size());
+    }
+
+    bool readFrame(std::string& payload, std::uint8_t& opcode)
+    {
+        char buffer[65536];
+        while (!m_reader.next(payload, opcode)) {
+            const auto received = readSome(buffer, sizeof(buffer));
+            if (received <= 0) return false;
+            m_reader.append(buffer, static_cast<std::size_t>(received));
+        }
+        return true;
+    }
+
+    bool resumed() const { return m_ssl && SSL_session_reused(m_ssl); }
+    SSL_SESSION* takeSession() const { return m_ssl ? SSL_get1_session(m_ssl) : nullptr; }
+
+    void shutdown()
+    {
+        if (m_ssl) {
+            SSL_shutdown(m_ssl);
+            SSL_free(m_ssl);
+            m_ssl = nullptr;
+        }
+        if (m_fd != -1) close(m_fd);
+        m_fd = -1;
+    }
+
+private:
+    long readSome(char* buffer, std::size_t size)
+    {
+        if (m_ssl) return SSL_read(m_ssl, buffer, static_cast<int>(size));
+        return recv(m_fd, buffer, size, 0);
+    }
+
+    int m_fd = -1;
+    SSL* m_ssl = nullptr;
+    wsbench::FrameReader m_reader;
+};
+
+struct HandshakeResult {
+    std::size_t completed = 0;
+    std::size_t resumed = 0;
+    std::vector<std::int64_t> tls;
+    std::vector<std::int64_t> total;
+};
+
+double percentileUs(std::vector<std::int64_t>& values, double p)
+{
+    if (values.empty()) return 0;
+    std::sort(values.begin(), values.end());
+    return static_cast<double>(values[static_cast<std::size_t>(p * (values.size() - 1))]) / 1000.0;
+}
+
+void runHandshakes(const Options& options, SSL_CTX* context, bool resume, std::size_t thread, HandshakeResult& result)
+{
+    const auto sessionId = std::string("tls-bench-") + (resume ? "resumed-" : "full-") + std::to_string(thread);
+    SSL_SESSION* session = nullptr;
+    for (std::size_t i = thread; i < options.connections; i += options.threads) {
+        Connection connection;
+        const auto begin = wsbench::nowNs();
+        std::int64_t tlsDone = 0;
+        if (!connection.open(options, options.port, context, session, sessionId, &tlsDone)) continue;
+        const auto end = wsbench::nowNs();
+        ++result.completed;
+        if (connection.resumed()) ++result.resumed;
+        result.tls.push_back(tlsDone - begin);
+        result.total.push_back(end - begin);
+        if (resume) {
+            // The server's ticket follows the handshake, so the session is
+            // taken after the upgrade response has been read.
+            if (session) SSL_SESSION_free(session);
+            session = connection.takeSession();
+        }
+    }
+    if (session) SSL_SESSION_free(session);
+}
+
+bool reportHandshakes(const Options& options, SSL_CTX* context, bool resume)
+{
+    std::vector<HandshakeResult> results(options.threads);
+    std::vector<std::thread> threads;
+    const auto begin = wsbench::nowNs();
+    for (std::size_t t = 0; t < options.threads; ++t) threads.emplace_back(runHandshakes, std::cref(options), context, resume, t, std::ref(results[t]));
+    for (auto& thread : threads) thread.join();
+    const auto seconds = static_cast<double>(wsbench::nowNs() - begin) / 1e9;
+
+    HandshakeResult total;
+    for (auto& result : results) {
+        total.completed += result.completed;
+        total.resumed += result.resumed;
+        total.tls.insert(total.tls.end(), result.tls.begin(), result.tls.end());
+        total.total.insert(total.total.end(), result.total.begin(), result.total.end());
+    }
+    std::cout << (resume ? "resumed handshakes\n" : "full handshakes\n")
+              << "  completed:            " << total.completed << " / " << options.connections << " (" << total.resumed << " resumed)\n"
+              << "  connections/sec:      " << static_cast<double>(total.completed) / seconds << '\n'
+              << "  tls p50/p99:          " << percentileUs(total.tls, 0.5) << " / " << percentileUs(total.tls, 0.99) << " us\n"
+              << "  tls + upgrade p50/p99: " << percentileUs(total.total, 0.5) << " / " << percentileUs(total.total, 0.99) << " us\n";
+    return total.completed == options.connections;
+}
+
+struct RelayPair {
+    Connection sender;
+    Connection receiver;
+    std::string senderId;
+    std::string receiverId;
+    std::size_t received = 0;
+};
+
+void runRelay(const Options& options, RelayPair& pair)
+{
+    const std::string padding(options.size > 96 ? options.size - 96 : 0, 'x');
+    const auto frame = wsbench::encodeFrame("{\"type\":\"bench\",\"sender\":\"" + pair.senderId + "\",\"receiver\":\"" + pair.receiverId
+        + "\",\"data\":\"" + padding + "\"}");
+    std::string payload;
+    std::uint8_t opcode = 0;
+    std::size_t sent = 0;
+    while (pair.received < options.messages) {
+        while (sent < options.messages && sent - pair.received < options.window) {
+            if (!pair.sender.write(frame)) return;
+            ++sent;
+        }
+        if (!pair.receiver.readFrame(payload, opcode)) return;
+        if (opcode == 0x1 && payload.find("\"type\":\"bench\"") != std::string::npos) ++pair.received;
+    }
+}
+
+bool reportRelay(const Options& options, SSL_CTX* context)
+{
+    const auto port = context ? options.port : options.plainPort;
+    const std::string tag = context ? "tls" : "plain";
+    std::vector<RelayPair> pairs(options.pairs);
+    for (std::size_t i = 0; i < pairs.size(); ++i) {
+        auto& pair = pairs[i];
+        pair.senderId = "tls-bench-" + tag + "-s-" + std::to_string(i);
+        pair.receiverId = "tls-bench-" + tag + "-r-" + std::to_string(i);
+        if (!pair.sender.open(options, port, context, nullptr, pair.senderId) || !pair.receiver.open(options, port, context, nullptr, pair.receiverId)) {
+            std::cerr << tag << " pair " << i << " failed to connect\n";
+            return false;
+        }
+    }
+    std::vector<std::thread> threads;
+    const auto begin = wsbench::nowNs();
+    for (auto& pair : pairs) threads.emplace_back(runRelay, std::cref(options), std::ref(pair));
+    for (auto& thread : threads) thread.join();
+    const auto seconds = static_cast<double>(wsbench::nowNs() - begin) / 1e9;
+    std::size_t received = 0;
+    for (const auto& pair : pairs) received += pair.received;
+    const auto rate = static_cast<double>(received) / seconds;
+    std::cout << (context ? "relay over wss://\n" : "relay over ws://\n")
+              << "  relayed messages:     " << received << " / " << options.pairs * options.messages << '\n'
+              << "  messages/sec:         " << rate << '\n'
+              << "  MB/sec:               " << rate * static_cast<double>(std::max<std::size_t>(options.size, 96)) / 1e6 << '\n';
+    return received == options.pairs * options.messages;
+}
+
+void printUsage()
+{
+    std::cout << "tls_bench [--host H] [--port TLS_PORT] [--plain-port P] [--connections N] [--threads N]\n"
+                 "          [--pairs N] [--messages N] [--size BYTES] [--window N] [--mode handshake|relay|all]\n"
+                 "  Start the server with [tls] enabled=true and [rate_limit] messagesPerSecond=0 (the default).\n";
+}
+}
+
+int main(int argc, char* argv[])
+{
+    Options options;
+    for (int i = 1; i + 1 < argc; i += 2) {
+        const std::string key = argv[i];
+        const std::string value = argv[i + 1];
+        if (key == "--host") options.host = value;
+        else if (key == "--port") options.port = static_cast<std::uint16_t>(std::stoul(value));
+        else if (key == "--plain-port") options.plainPort = static_cast<std::uint16_t>(std::stoul(value));
+        else if (key == "--connections") options.connections = std::max<std::size_t>(1, std::stoul(value));
+        else if (key == "--threads") options.threads = std::max<std::size_t>(1, std::stoul(value));
+        else if (key == "--pairs") options.pairs = std::max<std::size_t>(1, std::stoul(value));
+        else if (key == "--messages") options.messages = std::max<std::size_t>(1, std::stoul(value));
+        else if (key == "--size") options.size = std::stoul(value);
+        else if (key == "--window") options.window = std::max<std::size_t>(1, std::stoul(value));
+        else if (key == "--mode") options.mode = value;
+        else {
+            printUsage();
+            return 1;
+        }
+    }
+
+    std::signal(SIGPIPE, SIG_IGN);
+    SSL_CTX* context = SSL_CTX_new(TLS_client_method());
+    SSL_CTX_set_verify(context, SSL_VERIFY_NONE, nullptr);
+    bool ok = true;
+    if (options.mode == "handshake" || options.mode == "all") {
+        ok = reportHandshakes(options, context, false) && ok;
+        ok = reportHandshakes(options, context, true) && ok;
+    }
+    if (options.mode == "relay" || options.mode == "all") {
+        ok = reportRelay(options, nullptr) && ok;
+        ok = reportRelay(options, context) && ok;
+    }
+    SSL_CTX_free(context);
+    return ok ? 0 : 1;
+}
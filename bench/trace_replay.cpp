@@ -0,0 +1,235 @@
+#include "tracefile.h"
+#include "wsclient.h"
+
+#include <algorithm>
+#include <deque>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <sys/epoll.h>
+#include <unordered_map>
+#include <vector>
+
+namespace {
+struct Options {
+    std::string trace;
+    std::string host = "127.0.0.1";
+    std::uint16_t port = 3480;
+    double speed = 1.0;
+    int drainMs = 5000;
+};
+
+struct Peer {
+    int fd = -1;
+    std::string session;
+    wsbench::FrameReader reader;
+};
+
+class Replayer {
+public:
+    explicit Replayer(const Options& options) : m_options(options), m_epollFd(epoll_create1(0)) {}
+
+    ~Replayer()
+    {
+        for (auto& entry : m_peers) ::close(entry.second->fd);
+        ::close(m_epollFd);
+    }
+
+    void connect(const std::string& session)
+    {
+        disconnect(session);
+        auto peer = std::make_unique<Peer>();
+        peer->session = session;
+        peer->fd = wsbench::connectTcp(m_options.host, m_options.port);
+        std::string leftover;
+        if (peer->fd == -1 || !wsbench::handshake(peer->fd, m_options.host, m_options.port, "/?sessionId=" + session + "&hostname=replay", leftover)) {
+            if (peer->fd != -1) ::close(peer->fd);
+            ++m_failedConnects;
+            return;
+        }
+        peer->reader.append(leftover.data(), leftover.size());
+        wsbench::setNonBlocking(peer->fd);
+        epoll_event event{};
+        event.events = EPOLLIN;
+        event.data.ptr = peer.get();
+        epoll_ctl(m_epollFd, EPOLL_CTL_ADD, peer->fd, &event);
+        ++m_connects;
+        m_peers[session] = std::move(peer);
+        drainFrames(*m_peers[session]);
+    }
+
+    void disconnect(const std::string& session)
+    {
+        const auto it = m_peers.find(session);
+        if (it == m_peers.end()) return;
+        epoll_ctl(m_epollFd, EPOLL_CTL_DEL, it->second->fd, nullptr);
+        ::close(it->second->fd);
+        m_pending.erase(session);
+        m_peers.erase(it);
+    }
+
+    void send(const TraceRecord& record)
+    {
+        const auto it = m_peers.find(record.session);
+        if (it == m_peers.end()) {
+            ++m_skipped;
+            return;
+        }
+        const auto payload = record.hasPayload ? record.payload : synthesize(record);
+        const auto frame = wsbench::encodeFrame(payload);
+        if (!wsbench::sendAll(it->second->fd, frame.data(), frame.size())) {
+            ++m_skipped;
+            return;
+        }
+        ++m_sent;
+        m_sentBytes += payload.size();
+        if (!record.receiver.empty() && m_peers.count(record.receiver)) m_pending[record.receiver].push_back(wsbench::nowNs());
+    }
+
+    // Reads whatever has arrived, waiting up to timeoutMs for the first event.
+    void poll(int timeoutMs)
+    {
+        epoll_event events[128];
+        const int count = epoll_wait(m_epollFd, events, 128, timeoutMs);
+        for (int i = 0; i < count; ++i) drainFrames(*static_cast<Peer*>(events[i].data.ptr));
+    }
+
+    std::size_t outstanding() const
+    {
+        std::size_t total = 0;
+        for (const auto& entry : m_pending) total += entry.second.size();
+        return total;
+    }
+
+    void report(double seconds, double recordedSeconds)
+    {
+        std::sort(m_latencies.begin(), m_latencies.end());
+        const auto percentile = [this](double p) {
+            return m_latencies.empty() ? 0.0 : static_cast<double>(m_latencies[static_cast<std::size_t>(p * (m_latencies.size() - 1))]) / 1000.0;
+        };
+        std::cout << "connections:         " << m_connects << " (" << m_failedConnects << " failed)\n"
+                  << "messages sent:       " << m_sent << " (" << m_skipped << " skipped)\n"
+                  << "bytes sent:          " << m_sentBytes << '\n'
+                  << "relayed received:    " << m_latencies.size() << " (" << outstanding() << " missing)\n"
+                  << "server replies:      " << m_serverReplies << '\n'
+                  << "recorded duration:   " << recordedSeconds << " s\n"
+                  << "replay duration:     " << seconds << " s\n"
+                  << "messages/sec:        " << static_cast<double>(m_sent) / seconds << '\n'
+                  << "latency p50/p99/max: " << percentile(0.5) << " / " << percentile(0.99) << " / " << percentile(1.0) << " us\n";
+    }
+
+private:
+    static std::string synthesize(const TraceRecord& record)
+    {
+        if (record.receiver.empty() && record.size == 6) return "@heart";
+        std::string payload = "{\"type\":\"replay\",\"sender\":\"" + record.session + "\",\"receiver\":\"" + record.receiver + "\",\"data\":\"";
+        if (payload.size() + 2 < record.size) payload.append(record.size - payload.size() - 2, 'x');
+        return payload + "\"}";
+    }
+
+    void drainFrames(Peer& peer)
+    {
+        char buffer[65536];
+        while (true) {
+            const auto received = recv(peer.fd, buffer, sizeof(buffer), 0);
+            if (received <= 0) break;
+            peer.reader.append(buffer, static_cast<std::size_t>(received));
+        }
+        std::string payload;
+        std::uint8_t opcode = 0;
+        while (peer.reader.next(payload, opcode)) {
+            if (opcode != 0x1) continue;
+            if (payload.find("\"sender\":\"server\"") != std::string::npos) {
+                ++m_serverReplies;
+                continue;
+            }
+            auto& queue = m_pending[peer.session];
+            if (queue.empty()) continue;
+            m_latencies.push_back(wsbench::nowNs() - queue.front());
+            queue.pop_front();
+        }
+    }
+
+    const Options& m_options;
+    int m_epollFd;
+    std::unordered_map<std::string, std::unique_ptr<Peer>> m_peers;
+    std::unordered_map<std::string, std::deque<std::int64_t>> m_pending;
+    std::vector<std::int64_t> m_latencies;
+    std::size_t m_connects = 0;
+    std::size_t m_failedConnects = 0;
+    std::size_t m_sent = 0;
+    std::size_t m_skipped = 0;
+    std::size_t m_sentBytes = 0;
+    std::size_t m_serverReplies = 0;
+};
+
+void printUsage()
+{
+    std::cout << "trace_replay TRACE [--host H] [--port P] [--speed X] [--drain-ms N]\n"
+                 "  --speed 1 replays at recorded speed, 2 twice as fast, 0 as fast as possible\n";
+}
+}
+
+int main(int argc, char* argv[])
+{
+    Options options;
+    if (argc < 2 || argc % 2 != 0) {
+        printUsage();
+        return 1;
+    }
+    options.trace = argv[1];
+    for (int i = 2; i + 1 < argc; i += 2) {
+        const std::string key = argv[i];
+        const std::string value = argv[i + 1];
+        if (key == "--host") options.host = value;
+        else if (key == "--port") options.port = static_cast<std::uint16_t>(std::stoul(value));
+        else if (key == "--speed") options.speed = std::max(0.0, std::stod(value));
+        else if (key == "--drain-ms") options.drainMs = std::stoi(value);
+        else {
+            printUsage();
+            return 1;
+        }
+    }
+
+    TraceReader reader(options.trace);
+    if (!reader.isValid()) {
+        std::cerr << "not a trace file: " << options.trace << '\n';
+        return 1;
+    }
+    std::vector<TraceRecord> records;
+    TraceRecord record;
+    while (reader.next(record)) records.push_back(record);
+    if (records.empty()) {
+        std::cerr << "trace is empty\n";
+        return 1;
+    }
+    const auto firstNs = records.front().timestampNs;
+    const auto recordedSeconds = static_cast<double>(records.back().timestampNs - firstNs) / 1e9;
+
+    Replayer replayer(options);
+    const auto begin = wsbench::nowNs();
+    for (const auto& entry : records) {
+        if (options.speed > 0) {
+            const auto target = begin + static_cast<std::int64_t>(static_cast<double>(entry.timestampNs - firstNs) / options.speed);
+            for (auto now = wsbench::nowNs(); now < target; now = wsbench::nowNs()) replayer.poll(static_cast<int>((target - now + 999999) / 1000000));
+        }
+        switch (entry.type) {
+        case TraceRecordType::Connect:
+            replayer.connect(entry.session);
+            break;
+        case TraceRecordType::Disconnect:
+            replayer.disconnect(entry.session);
+            break;
+        case TraceRecordType::Message:
+            replayer.send(entry);
+            break;
+        }
+        replayer.poll(0);
+    }
+    const auto sendEnd = wsbench::nowNs();
+    for (auto deadline = sendEnd + static_cast<std::int64_t>(options.drainMs) * 1000000; replayer.outstanding() > 0 && wsbench::nowNs() < deadline;)
+        replayer.poll(10);
+
+    replayer.report(static_cast<double>(sendEnd - begin) / 1e9, recordedSeconds);
+    return 0;
+}
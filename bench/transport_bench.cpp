@@ -0,0 +1,203 @@
+#include "wsclient.h"
+
+#include <algorithm>
+#include <atomic>
+#include <iostream>
+#include <string>
+#include <sys/epoll.h>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace {
+struct Options {
+    std::string host = "127.0.0.1";
+    std::uint16_t port = 3480;
+    std::size_t pairs = 50;
+    std::size_t idle = 0;
+    std::size_t messages = 20000;
+    std::size_t size = 256;
+    std::size_t window = 16;
+    std::size_t threads = 1;
+    long pid = 0;
+    unsigned serverCores = 1;
+};
+
+struct Peer {
+    int fd = -1;
+    std::string pending;
+    wsbench::FrameReader reader;
+};
+
+struct Pair {
+    Peer sender;
+    Peer receiver;
+    std::string senderId;
+    std::string receiverId;
+    std::size_t sent = 0;
+    std::size_t received = 0;
+};
+
+struct ThreadResult {
+    std::size_t received = 0;
+    std::vector<std::int64_t> latencies;
+};
+
+bool openPeer(const Options& options, const std::string& sessionId, Peer& peer)
+{
+    peer.fd = wsbench::connectTcp(options.host, options.port);
+    if (peer.fd == -1) return false;
+    std::string leftover;
+    if (!wsbench::handshake(peer.fd, options.host, options.port, "/?sessionId=" + sessionId + "&hostname=bench", leftover)) return false;
+    peer.reader.append(leftover.data(), leftover.size());
+    wsbench::setNonBlocking(peer.fd);
+    return true;
+}
+
+void sendMessages(const Options& options, Pair& pair, const std::string& padding)
+{
+    while (pair.sent < options.messages && pair.sent - pair.received < options.window) {
+        const auto payload = "{\"type\":\"bench\",\"sender\":\"" + pair.senderId + "\",\"receiver\":\"" + pair.receiverId
+            + "\",\"data\":\"" + std::to_string(wsbench::nowNs()) + ":" + padding + "\"}";
+        const auto frame = wsbench::encodeFrame(payload);
+        if (!wsbench::sendAll(pair.sender.fd, frame.data(), frame.size())) return;
+        ++pair.sent;
+    }
+}
+
+void runPairs(const Options& options, std::vector<Pair*> pairs, ThreadResult& result)
+{
+    const std::string padding(options.size > 96 ? options.size - 96 : 0, 'x');
+    const int epollFd = epoll_create1(0);
+    std::unordered_map<int, Pair*> byReceiver;
+    for (auto* pair : pairs) {
+        epoll_event event{};
+        event.events = EPOLLIN;
+        event.data.fd = pair->receiver.fd;
+        epoll_ctl(epollFd, EPOLL_CTL_ADD, pair->receiver.fd, &event);
+        byReceiver[pair->receiver.fd] = pair;
+        sendMessages(options, *pair, padding);
+    }
+    std::size_t finished = 0;
+    epoll_event events[128];
+    char buffer[65536];
+    std::string payload;
+    std::uint8_t opcode = 0;
+    while (finished < pairs.size()) {
+        const int count = epoll_wait(epollFd, events, 128, 5000);
+        if (count <= 0) break;
+        for (int i = 0; i < count; ++i) {
+            auto* pair = byReceiver[events[i].data.fd];
+            while (true) {
+                const auto received = recv(pair->receiver.fd, buffer, sizeof(buffer), 0);
+                if (received <= 0) break;
+                pair->receiver.reader.append(buffer, static_cast<std::size_t>(received));
+            }
+            const auto before = pair->received;
+            while (pair->receiver.reader.next(payload, opcode)) {
+                if (opcode != 0x1) continue;
+                const auto data = payload.find("\"data\":\"");
+                if (data != std::string::npos) result.latencies.push_back(wsbench::nowNs() - std::stoll(payload.substr(data + 8)));
+                ++pair->received;
+            }
+            result.received += pair->received - before;
+            if (before < options.messages && pair->received >= options.messages) ++finished;
+            sendMessages(options, *pair, padding);
+        }
+    }
+    close(epollFd);
+}
+
+void printUsage()
+{
+    std::cout << "transport_bench [--host H] [--port P] [--pairs N] [--idle N] [--messages N] [--size BYTES]\n"
+                 "                [--window N] [--threads N] [--pid SERVER_PID] [--server-cores N]\n"
+                 "  Keep the server's [rate_limit] messagesPerSecond=0 (the default), otherwise the senders are throttled.\n";
+}
+}
+
+int main(int argc, char* argv[])
+{
+    Options options;
+    for (int i = 1; i + 1 < argc; i += 2) {
+        const std::string key = argv[i];
+        const std::string value = argv[i + 1];
+        if (key == "--host") options.host = value;
+        else if (key == "--port") options.port = static_cast<std::uint16_t>(std::stoul(value));
+        else if (key == "--pairs") options.pairs = std::stoul(value);
+        else if (key == "--idle") options.idle = std::stoul(value);
+        else if (key == "--messages") options.messages = std::stoul(value);
+        else if (key == "--size") options.size = std::stoul(value);
+        else if (key == "--window") options.window = std::max<std::size_t>(1, std::stoul(value));
+        else if (key == "--threads") options.threads = std::max<std::size_t>(1, std::stoul(value));
+        else if (key == "--pid") options.pid = std::stol(value);
+        else if (key == "--server-cores") options.serverCores = std::max(1u, static_cast<unsigned>(std::stoul(value)));
+        else {
+            printUsage();
+            return 1;
+        }
+    }
+
+    const auto rssBefore = options.pid ? wsbench::readRssBytes(options.pid) : 0;
+    std::vector<Peer> idle(options.idle);
+    for (std::size_t i = 0; i < idle.size(); ++i) {
+        if (!openPeer(options, "bench-idle-" + std::to_string(i), idle[i])) {
+            std::cerr << "connection " << i << " failed\n";
+            return 1;
+        }
+    }
+    std::vector<Pair> pairs(options.pairs);
+    for (std::size_t i = 0; i < pairs.size(); ++i) {
+        pairs[i].senderId = "bench-s-" + std::to_string(i);
+        pairs[i].receiverId = "bench-r-" + std::to_string(i);
+        if (!openPeer(options, pairs[i].senderId, pairs[i].sender) || !openPeer(options, pairs[i].receiverId, pairs[i].receiver)) {
+            std::cerr << "pair " << i << " failed to connect\n";
+            return 1;
+        }
+    }
+    const auto connections = idle.size() + pairs.size() * 2;
+    if (options.pid) {
+        std::this_thread::sleep_for(std::chrono::seconds(1));
+        const auto rssAfter = wsbench::readRssBytes(options.pid);
+        const double perConnection = connections ? static_cast<double>(rssAfter - std::min(rssAfter, rssBefore)) / connections : 0;
+        std::cout << "server rss:          " << rssBefore / 1024 << " KiB -> " << rssAfter / 1024 << " KiB\n"
+                  << "rss per connection:  " << perConnection << " bytes\n";
+        if (perConnection > 0) std::cout << "connections per GB:  " << static_cast<std::uint64_t>((1ULL << 30) / perConnection) << '\n';
+    }
+
+    std::vector<ThreadResult> results(options.threads);
+    std::vector<std::thread> threads;
+    const auto begin = wsbench::nowNs();
+    for (std::size_t t = 0; t < options.threads; ++t) {
+        std::vector<Pair*> assigned;
+        for (std::size_t i = t; i < pairs.size(); i += options.threads) assigned.push_back(&pairs[i]);
+        threads.emplace_back(runPairs, std::cref(options), std::move(assigned), std::ref(results[t]));
+    }
+    for (auto& thread : threads) thread.join();
+    const auto seconds = static_cast<double>(wsbench::nowNs() - begin) / 1e9;
+
+    std::size_t received = 0;
+    std::vector<std::int64_t> latencies;
+    for (auto& result : results) {
+        received += result.received;
+        latencies.insert(latencies.end(), result.latencies.begin(), result.latencies.end());
+    }
+    std::sort(latencies.begin(), latencies.end());
+    const auto percentile = [&latencies](double p) {
+        return latencies.empty() ? 0.0 : static_cast<double>(latencies[static_cast<std::size_t>(p * (latencies.size() - 1))]) / 1000.0;
+    };
+    const auto rate = static_cast<double>(received) / seconds;
+    std::cout << "connections:         " << connections << '\n'
+              << "relayed messages:    " << received << " / " << options.pairs * options.messages << '\n'
+              << "elapsed:             " << seconds << " s\n"
+              << "messages/sec:        " << rate << '\n'
+              << "messages/sec/core:   " << rate / options.serverCores << '\n'
+              << "latency p50/p99:     " << percentile(0.5) << " / " << percentile(0.99) << " us\n";
+
+    for (auto& peer : idle) close(peer.fd);
+    for (auto& pair : pairs) {
+        close(pair.sender.fd);
+        close(pair.receiver.fd);
+    }
+    return 0;
+}
@@ -0,0 +1,173 @@
+#pragma once
+
+#include <arpa/inet.h>
+#include <cerrno>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <random>
+#include <string>
+#include <sys/socket.h>
+#include <unistd.h>
+
+namespace wsbench {
+
+inline std::int64_t nowNs()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+inline int connectTcp(const std::string& host, std::uint16_t port)
+{
+    addrinfo hints{};
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    addrinfo* result = nullptr;
+    if (getaddrinfo(host.c_str(), std::to_string(port).c_str(), &hints, &result) != 0) return -1;
+    int fd = -1;
+    for (auto* address = result; address; address = address->ai_next) {
+        fd = socket(address->ai_family, address->ai_socktype, address->ai_protocol);
+        if (fd == -1) continue;
+        if (connect(fd, address->ai_addr, address->ai_addrlen) == 0) break;
+        close(fd);
+        fd = -1;
+    }
+    freeaddrinfo(result);
+    if (fd != -1) {
+        const int on = 1;
+        setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &on, sizeof(on));
+    }
+    return fd;
+}
+
+inline bool sendAll(int fd, const char* data, std::size_t size)
+{
+    while (size > 0) {
+        const auto written = send(fd, data, size, MSG_NOSIGNAL);
+        if (written < 0 && (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR)) {
+            pollfd waiter{fd, POLLOUT, 0};
+            poll(&waiter, 1, 1000);
+            continue;
+        }
+        if (written <= 0) return false;
+        data += written;
+        size -= static_cast<std::size_t>(written);
+    }
+    return true;
+}
+
+inline std::string handshakeRequest(const std::string& host, std::uint16_t port, const std::string& resource)
+{
+    return "GET " + resource + " HTTP/1.1\r\nHost: " + host + ":" + std::to_string(port)
+        + "\r\nUpgrade: websocket\r\nConnection: Upgrade\r\nSec-WebSocket-Key: dGhlIHNhbXBsZSBub25jZQ==\r\n"
+          "Sec-WebSocket-Version: 13\r\n\r\n";
+}
+
+// Blocking upgrade on a connected socket. Bytes received after the 101 response
+// are returned in leftover.
+inline bool handshake(int fd, const std::string& host, std::uint16_t port, const std::string& resource, std::string& leftover)
+{
+    const auto request = handshakeRequest(host, port, resource);
+    if (!sendAll(fd, request.data(), request.size())) return false;
+    std::string response;
+    char buffer[4096];
+    while (response.find("\r\n\r\n") == std::string::npos) {
+        const auto received = recv(fd, buffer, sizeof(buffer), 0);
+        if (received <= 0) return false;
+        response.append(buffer, static_cast<std::size_t>(received));
+    }
+    const auto end = response.find("\r\n\r\n") + 4;
+    leftover = response.substr(end);
+    return response.compare(0, 12, "HTTP/1.1 101") == 0;
+}
+
+inline void setNonBlocking(int fd) { fcntl(fd, F_SETFL, fcntl(fd, F_GETFL, 0) | O_NONBLOCK); }
+
+inline std::string encodeFrame(const std::string& payload, std::uint8_t opcode = 0x1)
+{
+    static thread_local std::mt19937 random(std::random_device{}());
+    std::string frame;
+    frame.reserve(payload.size() + 14);
+    frame.push_back(static_cast<char>(0x80 | opcode));
+    if (payload.size() < 126) {
+        frame.push_back(static_cast<char>(0x80 | payload.size()));
+    } else if (payload.size() <= 0xFFFF) {
+        frame.push_back(static_cast<char>(0x80 | 126));
+        frame.push_back(static_cast<char>(payload.size() >> 8));
+        frame.push_back(static_cast<char>(payload.size()));
+    } else {
+        frame.push_back(static_cast<char>(0x80 | 127));
+        for (int i = 0; i < 8; ++i) frame.push_back(static_cast<char>(static_cast<std::uint64_t>(payload.size()) >> (56 - 8 * i)));
+    }
+    const auto key = static_cast<std::uint32_t>(random());
+    char mask[4];
+    std::memcpy(mask, &key, sizeof(mask));
+    frame.append(mask, sizeof(mask));
+    const auto start = frame.size();
+    frame.append(payload);
+    for (std::size_t i = 0; i < payload.size(); ++i) frame[start + i] ^= mask[i & 3];
+    return frame;
+}
+
+// Incremental parser for unmasked server-to-client frames.
+class FrameReader {
+public:
+    void append(const char* data, std::size_t size) { m_buffer.append(data, size); }
+
+    bool next(std::string& payload, std::uint8_t& opcode)
+    {
+        const auto available = m_buffer.size() - m_offset;
+        if (available < 2) return compact();
+        const auto* frame = reinterpret_cast<const unsigned char*>(m_buffer.data() + m_offset);
+        opcode = frame[0] & 0x0F;
+        std::uint64_t length = frame[1] & 0x7F;
+        std::size_t header = 2;
+        if (length == 126) {
+            if (available < 4) return compact();
+            length = (static_cast<std::uint64_t>(frame[2]) << 8) | frame[3];
+            header = 4;
+        } else if (length == 127) {
+            if (available < 10) return compact();
+            length = 0;
+            for (int i = 0; i < 8; ++i) length = (length << 8) | frame[2 + i];
+            header = 10;
+        }
+        if (available < header + length) return compact();
+        payload.assign(m_buffer, m_offset + header, static_cast<std::size_t>(length));
+        m_offset += header + static_cast<std::size_t>(length);
+        return true;
+    }
+
+private:
+    bool compact()
+    {
+        if (m_offset > 0) {
+            m_buffer.erase(0, m_offset);
+            m_offset = 0;
+        }
+        return false;
+    }
+
+    std::string m_buffer;
+    std::size_t m_offset = 0;
+};
+
+inline std::size_t readRssBytes(long pid)
+{
+    const auto path = "/proc/" + std::to_string(pid) + "/statm";
+    FILE* file = std::fopen(path.c_str(), "r");
+    if (!file) return 0;
+    unsigned long size = 0;
+    unsigned long resident = 0;
+    const int fields = std::fscanf(file, "%lu %lu", &size, &resident);
+    std::fclose(file);
+    return fields == 2 ? resident * static_cast<std::size_t>(sysconf(_SC_PAGESIZE)) : 0;
+}
+
+}
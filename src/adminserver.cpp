@@ -0,0 +1,180 @@
+#include "adminserver.h"
+#include "logger_manager.h"
+#include "websocketserver.h"
+
+#include <algorithm>
+#include <chrono>
+
+namespace {
+std::int64_t currentTimeMs()
+{
+    return std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+}
+
+bool constantTimeEquals(const std::string& left, const std::string& right)
+{
+    if (left.size() != right.size()) return false;
+    unsigned char difference = 0;
+    for (std::size_t i = 0; i < left.size(); ++i) difference |= static_cast<unsigned char>(left[i] ^ right[i]);
+    return difference == 0;
+}
+
+struct SessionRow {
+    std::shared_ptr<WebSocketClient> client;
+    ClientTrafficStats stats;
+    std::size_t sendQueue = 0;
+};
+
+std::uint64_t sortValue(const SessionRow& row, const std::string& key)
+{
+    if (key == "messages") return row.stats.messagesIn + row.stats.messagesOut;
+    if (key == "bytesIn") return row.stats.bytesIn;
+    if (key == "bytesOut") return row.stats.bytesOut;
+    if (key == "messagesIn") return row.stats.messagesIn;
+    if (key == "messagesOut") return row.stats.messagesOut;
+    if (key == "sendQueue") return row.sendQueue;
+    if (key == "lastActivity") return static_cast<std::uint64_t>(row.stats.lastActivityMs);
+    return row.stats.bytesIn + row.stats.bytesOut;
+}
+}
+
+AdminServer::AdminServer(WebSocketServer& server, AdminConfig config) : m_server(server), m_config(std::move(config))
+{
+    m_endpoint.clear_access_channels(websocketpp::log::alevel::all);
+    m_endpoint.clear_error_channels(websocketpp::log::elevel::all);
+    m_endpoint.set_http_handler([this](ConnectionHandle handle) { onHttp(handle); });
+    m_endpoint.set_open_handler([this](ConnectionHandle handle) {
+        websocketpp::lib::error_code error;
+        m_endpoint.close(handle, websocketpp::close::status::policy_violation, "admin endpoint is HTTP only", error);
+    });
+}
+
+bool AdminServer::start(asio::io_service& ioService)
+{
+    if (m_config.port == 0) return false;
+    if (m_config.token.empty()) {
+        LOG_WARN("Admin endpoint disabled: [admin] token is empty");
+        return false;
+    }
+    try {
+        m_endpoint.init_asio(&ioService);
+        m_endpoint.set_reuse_addr(true);
+        m_endpoint.listen(m_config.address, std::to_string(m_config.port));
+        m_endpoint.start_accept();
+        m_listening = true;
+        LOG_INFO("Admin endpoint listening on http://{}:{}", m_config.address, m_config.port);
+        return true;
+    } catch (const std::exception& error) {
+        LOG_ERROR("Unable to start admin endpoint on {}:{}: {}", m_config.address, m_config.port, error.what());
+        return false;
+    }
+}
+
+void AdminServer::stop()
+{
+    if (!m_listening) return;
+    m_listening = false;
+    websocketpp::lib::error_code error;
+    m_endpoint.stop_listening(error);
+}
+
+void AdminServer::onHttp(ConnectionHandle handle)
+{
+    auto connection = m_endpoint.get_con_from_hdl(handle);
+    const auto& request = connection->get_request();
+    connection->append_header("Content-Type", "application/json");
+    const auto respond = [&connection](websocketpp::http::status_code::value status, const nlohmann::json& body) {
+        connection->set_status(status);
+        connection->set_body(body.dump());
+    };
+
+    if (!isAuthorized(request.get_header("Authorization"))) {
+        connection->append_header("WWW-Authenticate", "Bearer");
+        respond(websocketpp::http::status_code::unauthorized, {{"error", "unauthorized"}});
+        return;
+    }
+    if (request.get_method() != "GET") {
+        respond(websocketpp::http::status_code::method_not_allowed, {{"error", "method not allowed"}});
+        return;
+    }
+
+    const auto& uri = request.get_uri();
+    const auto path = uri.substr(0, uri.find('?'));
+    if (path == "/sessions") respond(websocketpp::http::status_code::ok, listSessions(WebSocketServer::parseQuery(uri)));
+    else if (path == "/stats") respond(websocketpp::http::status_code::ok, summary());
+    else respond(websocketpp::http::status_code::not_found, {{"error", "not found"}});
+}
+
+bool AdminServer::isAuthorized(const std::string& authorization) const
+{
+    static const std::string scheme = "Bearer ";
+    if (authorization.compare(0, scheme.size(), scheme) != 0) return false;
+    return constantTimeEquals(authorization.substr(scheme.size()), m_config.token);
+}
+
+nlohmann::json AdminServer::listSessions(const std::unordered_map<std::string, std::string>& query) const
+{
+    std::vector<SessionRow> rows;
+    for (auto& client : m_server.getClients()) {
+        SessionRow row;
+        row.stats = client->getTrafficStats();
+        row.sendQueue = client->getSendQueueDepth();
+        row.client = std::move(client);
+        rows.push_back(std::move(row));
+    }
+
+    const auto sortIt = query.find("sort");
+    const auto sortKey = sortIt == query.end() ? "bytes" : sortIt->second;
+    std::size_t top = rows.size();
+    if (auto it = query.find("top"); it != query.end()) {
+        try { top = std::min<std::size_t>(std::stoul(it->second), rows.size()); } catch (...) {}
+    }
+    const auto greater = [&sortKey](const SessionRow& left, const SessionRow& right) {
+        return sortValue(left, sortKey) > sortValue(right, sortKey);
+    };
+    std::partial_sort(rows.begin(), rows.begin() + static_cast<std::ptrdiff_t>(top), rows.end(), greater);
+    rows.resize(top);
+
+    const auto now = currentTimeMs();
+    nlohmann::json sessions = nlohmann::json::array();
+    for (const auto& row : rows) {
+        sessions.push_back({{"sessionId", row.client->getSessionId()}, {"hostname", row.client->getHostname()},
+            {"remoteAddress", row.client->getRemoteAddress()}, {"messagesIn", row.stats.messagesIn},
+            {"bytesIn", row.stats.bytesIn}, {"messagesOut", row.stats.messagesOut}, {"bytesOut", row.stats.bytesOut},
+            {"sendQueueBytes", row.sendQueue}, {"connectedAtMs", row.stats.connectedAtMs},
+            {"lastActivityMs", row.stats.lastActivityMs}, {"idleMs", now - row.stats.lastActivityMs}});
+    }
+    return {{"online", m_server.getOnlineCount()}, {"sort", sortKey}, {"sessions", sessions}};
+}
+
+nlohmann::json AdminServer::summary() const
+{
+    const auto& rateLimit = m_server.getRateLimitStats();
+    const auto& storeForward = m_server.getOfflineQueue().getStats();
+    const auto& candidateBatch = m_server.getCandidateBatcher().getStats();
+    const auto& callTrace = m_server.getCallTracer().getStats();
+    nlohmann::json result = {{"serverName", m_server.getServerName()}, {"port", m_server.getPort()}, {"online", m_server.getOnlineCount()},
+        {"rateLimit", {{"dropped", rateLimit.dropped.load(std::memory_order_relaxed)},
+            {"receiverDropped", rateLimit.receiverDropped.load(std::memory_order_relaxed)},
+            {"errorReplies", rateLimit.errorReplies.load(std::memory_order_relaxed)},
+            {"disconnects", rateLimit.disconnects.load(std::memory_order_relaxed)}}},
+        {"storeForward", {{"queued", storeForward.queued.load(std::memory_order_relaxed)},
+            {"delivered", storeForward.delivered.load(std::memory_order_relaxed)},
+            {"expired", storeForward.expired.load(std::memory_order_relaxed)},
+            {"dropped", storeForward.dropped.load(std::memory_order_relaxed)},
+            {"heldBytes", m_server.getOfflineQueue().getQueuedBytes()}}},
+        {"candidateBatch", {{"held", candidateBatch.held.load(std::memory_order_relaxed)},
+            {"frames", candidateBatch.frames.load(std::memory_order_relaxed)},
+            {"unbatched", candidateBatch.unbatched.load(std::memory_order_relaxed)}}},
+        {"callTrace", {{"started", callTrace.started.load(std::memory_order_relaxed)},
+            {"connected", callTrace.connected.load(std::memory_order_relaxed)},
+            {"timedOut", callTrace.timedOut.load(std::memory_order_relaxed)},
+            {"active", m_server.getCallTracer().getActiveCalls()},
+            {"files", callTrace.files.load(std::memory_order_relaxed)}}}};
+#ifdef SIGNAL_SERVER_TLS
+    const auto& tls = m_server.getTlsContext().getStats();
+    result["tls"] = {{"started", tls.started.load(std::memory_order_relaxed)}, {"completed", tls.completed.load(std::memory_order_relaxed)},
+        {"resumed", tls.resumed.load(std::memory_order_relaxed)}, {"failed", tls.failed.load(std::memory_order_relaxed)}};
+#endif
+    return result;
+}
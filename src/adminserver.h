@@ -0,0 +1,29 @@
+#pragma once
+
+#include "config_util.h"
+#include "websocket_types.h"
+
+#include <string>
+#include <unordered_map>
+#include <nlohmann/json.hpp>
+
+class WebSocketServer;
+
+class AdminServer {
+public:
+    AdminServer(WebSocketServer& server, AdminConfig config);
+    bool start(asio::io_service& ioService);
+    void stop();
+    const AdminConfig& getConfig() const { return m_config; }
+
+private:
+    void onHttp(ConnectionHandle handle);
+    bool isAuthorized(const std::string& authorization) const;
+    nlohmann::json listSessions(const std::unordered_map<std::string, std::string>& query) const;
+    nlohmann::json summary() const;
+
+    WebSocketServer& m_server;
+    AdminConfig m_config;
+    WebSocketEndpoint m_endpoint;
+    bool m_listening = false;
+};
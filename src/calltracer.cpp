@@ -0,0 +1,198 @@
+#include "calltracer.h"
+#include "logger_manager.h"
+
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <functional>
+#include <nlohmann/json.hpp>
+
+namespace {
+std::string pairKey(const std::string& first, const std::string& second)
+{
+    return first < second ? first + '\n' + second : second + '\n' + first;
+}
+
+bool contains(const std::vector<std::string>& types, const std::string& type)
+{
+    return std::find(types.begin(), types.end(), type) != types.end();
+}
+}
+
+std::int64_t CallTracer::nowNs()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+CallTracer::CallTracer() : m_epochNs(nowNs()) {}
+
+void CallTracer::configure(const CallTraceConfig& config, const std::filesystem::path& directory)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_config = config;
+    m_directory = directory;
+    const auto rate = std::min(1.0, config.sampleRate);
+    m_sampleThreshold = static_cast<std::uint64_t>(rate * 4294967296.0);
+    m_enabled = config.enabled && rate > 0;
+}
+
+bool CallTracer::isSampled(const std::string& session) const
+{
+    return (std::hash<std::string>()(session) & 0xffffffffu) < m_sampleThreshold.load(std::memory_order_relaxed);
+}
+
+bool CallTracer::isTraced(const std::string& sender, const std::string& receiver) const
+{
+    return isEnabled() && !receiver.empty() && (isSampled(sender) || isSampled(receiver));
+}
+
+CallTracer::Stage CallTracer::classify(const std::string& type) const
+{
+    if (contains(m_config.offerTypes, type)) return Stage::Offer;
+    if (contains(m_config.answerTypes, type)) return Stage::Answer;
+    if (contains(m_config.candidateTypes, type)) return Stage::Candidate;
+    if (contains(m_config.connectedTypes, type)) return Stage::Connected;
+    return Stage::Other;
+}
+
+void CallTracer::record(const std::string& sender, const std::string& receiver, const std::string& type, std::int64_t receivedNs,
+    std::int64_t dispatchNs, std::int64_t handlerStartNs, std::int64_t handlerEndNs)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (!isEnabled()) return;
+    const auto stage = classify(type);
+    const auto key = pairKey(sender, receiver);
+    auto it = m_calls.find(key);
+    if (it == m_calls.end()) {
+        if (stage != Stage::Offer || !isSampled(sender) || m_calls.size() >= m_config.maxActiveCalls) return;
+        it = m_calls.emplace(key, Call()).first;
+        auto& call = it->second;
+        call.id = m_nextCallId++;
+        call.offerer = sender;
+        call.answerer = receiver;
+        call.startNs = receivedNs;
+        m_stats.started.fetch_add(1, std::memory_order_relaxed);
+    }
+    auto& call = it->second;
+    const int track = sender == call.offerer ? OffererTrack : AnswererTrack;
+    if (receivedNs < dispatchNs) addSpan(call, {type + " queue", "queue", track, receivedNs, dispatchNs});
+    addSpan(call, {type + " dispatch", "dispatch", track, dispatchNs, handlerStartNs});
+    addSpan(call, {type, "handler", track, handlerStartNs, handlerEndNs});
+    call.lastNs = handlerEndNs;
+    ++call.messages;
+    switch (stage) {
+    case Stage::Offer:
+        call.offerHandledNs = handlerEndNs;
+        call.offerTrack = track;
+        call.answered = false;
+        break;
+    case Stage::Answer:
+        if (call.offerHandledNs == 0 || call.answered || track == call.offerTrack) break;
+        addSpan(call, {"await answer", "peer", ServerTrack, call.offerHandledNs, receivedNs});
+        call.answered = true;
+        call.answerHandledNs = handlerEndNs;
+        break;
+    case Stage::Candidate:
+        ++call.candidates;
+        break;
+    case Stage::Connected:
+        addSpan(call, {"await connected", "peer", ServerTrack, call.answered ? call.answerHandledNs : call.offerHandledNs, receivedNs});
+        m_stats.connected.fetch_add(1, std::memory_order_relaxed);
+        finish(it, handlerEndNs, "connected");
+        break;
+    case Stage::Other:
+        break;
+    }
+}
+
+void CallTracer::addSpan(Call& call, Span span)
+{
+    // A long call with ICE restarts keeps adding spans; past the cap they are
+    // only counted so that one call cannot grow without limit.
+    if (call.spans.size() >= m_config.maxSpansPerCall) {
+        ++call.droppedSpans;
+        return;
+    }
+    call.spans.push_back(std::move(span));
+}
+
+void CallTracer::finish(std::unordered_map<std::string, Call>::iterator it, std::int64_t endNs, const char* outcome)
+{
+    auto& call = it->second;
+    call.outcome = outcome;
+    call.spans.push_back({"call setup", "call", ServerTrack, call.startNs, endNs});
+    m_finished.push_back(std::move(call));
+    m_calls.erase(it);
+}
+
+void CallTracer::expire(std::int64_t now)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    const bool all = !isEnabled();
+    const auto timeoutNs = static_cast<std::int64_t>(m_config.timeoutMs) * 1000000;
+    for (auto it = m_calls.begin(); it != m_calls.end();) {
+        const auto current = it++;
+        if (!all && current->second.lastNs + timeoutNs > now) continue;
+        m_stats.timedOut.fetch_add(1, std::memory_order_relaxed);
+        finish(current, current->second.lastNs, all ? "incomplete" : "timeout");
+    }
+}
+
+std::size_t CallTracer::flush(bool finishAll)
+{
+    std::vector<Call> calls;
+    std::filesystem::path directory;
+    std::uint64_t index = 0;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        while (finishAll && !m_calls.empty()) {
+            m_stats.timedOut.fetch_add(1, std::memory_order_relaxed);
+            finish(m_calls.begin(), m_calls.begin()->second.lastNs, "incomplete");
+        }
+        if (m_finished.empty()) return 0;
+        calls.swap(m_finished);
+        directory = m_directory;
+        index = ++m_fileIndex;
+    }
+
+    const auto micros = [this](std::int64_t ns) { return static_cast<double>(ns - m_epochNs) / 1000.0; };
+    nlohmann::json events = nlohmann::json::array();
+    for (const auto& call : calls) {
+        const auto pid = call.id;
+        events.push_back({{"name", "process_name"}, {"ph", "M"}, {"pid", pid}, {"args", {{"name", "call " + std::to_string(pid) + " " + call.offerer + " / " + call.answerer}}}});
+        events.push_back({{"name", "thread_name"}, {"ph", "M"}, {"pid", pid}, {"tid", OffererTrack}, {"args", {{"name", call.offerer + " -> " + call.answerer}}}});
+        events.push_back({{"name", "thread_name"}, {"ph", "M"}, {"pid", pid}, {"tid", AnswererTrack}, {"args", {{"name", call.answerer + " -> " + call.offerer}}}});
+        events.push_back({{"name", "thread_name"}, {"ph", "M"}, {"pid", pid}, {"tid", ServerTrack}, {"args", {{"name", "waiting"}}}});
+        for (const auto& span : call.spans) {
+            nlohmann::json event = {{"name", span.name}, {"cat", span.category}, {"ph", "X"}, {"pid", pid}, {"tid", span.track},
+                {"ts", micros(span.startNs)}, {"dur", static_cast<double>(std::max<std::int64_t>(0, span.endNs - span.startNs)) / 1000.0}};
+            if (&span == &call.spans.back()) {
+                event["args"] = {{"offerer", call.offerer}, {"answerer", call.answerer}, {"outcome", call.outcome},
+                    {"messages", call.messages}, {"candidates", call.candidates}, {"droppedSpans", call.droppedSpans}};
+            }
+            events.push_back(std::move(event));
+        }
+    }
+    nlohmann::json trace = {{"displayTimeUnit", "ms"}};
+    trace["traceEvents"] = std::move(events);
+
+    std::error_code error;
+    std::filesystem::create_directories(directory, error);
+    const auto stamp = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+    const auto path = directory / ("calls-" + std::to_string(stamp) + "-" + std::to_string(index) + ".json");
+    std::ofstream output(path, std::ios::trunc);
+    output << trace.dump();
+    if (!output) {
+        LOG_ERROR("Unable to write call trace {}", path.string());
+        return 0;
+    }
+    m_stats.files.fetch_add(1, std::memory_order_relaxed);
+    LOG_INFO("Wrote {} call trace(s) to {}", calls.size(), path.string());
+    return calls.size();
+}
+
+std::size_t CallTracer::getActiveCalls() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_calls.size();
+}
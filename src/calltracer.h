@@ -0,0 +1,91 @@
+#pragma once
+
+#include "config_util.h"
+
+#include <atomic>
+#include <cstdint>
+#include <filesystem>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+struct CallTraceStats {
+    std::atomic<std::uint64_t> started{0};
+    std::atomic<std::uint64_t> connected{0};
+    std::atomic<std::uint64_t> timedOut{0};
+    std::atomic<std::uint64_t> files{0};
+};
+
+// Follows call setup (offer, answer, candidates, connected) between a sampled
+// session and its peer, and writes the server-side spans of finished calls as
+// Chrome trace files: per message the time queued between the read and the
+// dispatch (native transport only), the dispatch time up to the handler and
+// the time in the handler, plus the time spent waiting for the peer's answer
+// and for the connection to be reported.
+class CallTracer {
+public:
+    static std::int64_t nowNs();
+
+    CallTracer();
+    void configure(const CallTraceConfig& config, const std::filesystem::path& directory);
+    bool isEnabled() const { return m_enabled.load(std::memory_order_relaxed); }
+    // Lock-free pre-check: only pairs with a sampled side can belong to a call.
+    bool isTraced(const std::string& sender, const std::string& receiver) const;
+    void record(const std::string& sender, const std::string& receiver, const std::string& type, std::int64_t receivedNs,
+        std::int64_t dispatchNs, std::int64_t handlerStartNs, std::int64_t handlerEndNs);
+    // Finishes calls idle for longer than timeoutMs, or every call once
+    // tracing has been disabled.
+    void expire(std::int64_t now = nowNs());
+    // Writes finished calls to a new file in the trace directory and returns
+    // how many were written. With finishAll, active calls are closed first.
+    std::size_t flush(bool finishAll = false);
+    std::size_t getActiveCalls() const;
+    const CallTraceStats& getStats() const { return m_stats; }
+
+private:
+    enum class Stage { Offer, Answer, Candidate, Connected, Other };
+    enum Track { OffererTrack = 1, AnswererTrack = 2, ServerTrack = 3 };
+
+    struct Span {
+        std::string name;
+        const char* category;
+        int track;
+        std::int64_t startNs;
+        std::int64_t endNs;
+    };
+
+    struct Call {
+        std::uint64_t id = 0;
+        std::string offerer;
+        std::string answerer;
+        std::string outcome;
+        std::int64_t startNs = 0;
+        std::int64_t lastNs = 0;
+        std::int64_t offerHandledNs = 0;
+        std::int64_t answerHandledNs = 0;
+        int offerTrack = OffererTrack;
+        bool answered = false;
+        std::size_t messages = 0;
+        std::size_t candidates = 0;
+        std::size_t droppedSpans = 0;
+        std::vector<Span> spans;
+    };
+
+    bool isSampled(const std::string& session) const;
+    Stage classify(const std::string& type) const;
+    void addSpan(Call& call, Span span);
+    void finish(std::unordered_map<std::string, Call>::iterator it, std::int64_t endNs, const char* outcome);
+
+    std::atomic_bool m_enabled{false};
+    std::atomic<std::uint64_t> m_sampleThreshold{0};
+    std::int64_t m_epochNs;
+    mutable std::mutex m_mutex;
+    CallTraceConfig m_config;
+    std::filesystem::path m_directory;
+    std::unordered_map<std::string, Call> m_calls;
+    std::vector<Call> m_finished;
+    std::uint64_t m_nextCallId = 1;
+    std::uint64_t m_fileIndex = 0;
+    CallTraceStats m_stats;
+};
@@ -0,0 +1,158 @@
+#include "candidatebatcher.h"
+
+#include <algorithm>
+#include <chrono>
+#include <nlohmann/json.hpp>
+
+CandidateBatcher::CandidateBatcher(asio::io_service& ioService, FlushHandler handler, BatchPredicate acceptsBatches)
+    : m_ioService(ioService), m_handler(std::move(handler)), m_acceptsBatches(std::move(acceptsBatches)),
+      m_config(std::make_shared<CandidateBatchConfig>()) {}
+
+void CandidateBatcher::configure(const CandidateBatchConfig& config)
+{
+    std::atomic_store(&m_config, std::shared_ptr<const CandidateBatchConfig>(std::make_shared<CandidateBatchConfig>(config)));
+    m_enabled = config.enabled && config.holdMs > 0 && config.maxBatch > 1 && !config.types.empty();
+    if (!m_enabled) flushAll();
+}
+
+bool CandidateBatcher::isBatchedType(const std::string& type) const
+{
+    const auto config = std::atomic_load(&m_config);
+    return std::find(config->types.begin(), config->types.end(), type) != config->types.end();
+}
+
+bool CandidateBatcher::submit(const std::string& sender, const std::string& receiver, const std::string& message, bool hold)
+{
+    if (!hold && m_pendingPairs.load(std::memory_order_acquire) == 0) return false;
+    const auto key = sender + '\n' + receiver;
+    if (!hold) {
+        std::shared_ptr<Pending> pending;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            const auto it = m_pending.find(key);
+            if (it == m_pending.end()) return false;
+            pending = it->second;
+        }
+        {
+            std::lock_guard<std::mutex> pairLock(pending->mutex);
+            deliver(*pending);
+        }
+        retire(key, pending);
+        return false;
+    }
+    const auto config = std::atomic_load(&m_config);
+    while (true) {
+        std::shared_ptr<Pending> pending;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            auto& slot = m_pending[key];
+            if (!slot) {
+                slot = std::make_shared<Pending>();
+                slot->sender = sender;
+                slot->receiver = receiver;
+                slot->generation = ++m_generation;
+                slot->timer = std::make_unique<asio::steady_timer>(m_ioService, std::chrono::milliseconds(config->holdMs));
+                slot->timer->async_wait([this, key, generation = slot->generation](const std::error_code& error) {
+                    if (!error) onTimer(key, generation);
+                });
+                m_pendingPairs.fetch_add(1, std::memory_order_release);
+            }
+            pending = slot;
+        }
+        bool stale = false;
+        bool full = false;
+        {
+            std::lock_guard<std::mutex> pairLock(pending->mutex);
+            stale = pending->delivered;
+            if (!stale) {
+                pending->messages.push_back(message);
+                m_stats.held.fetch_add(1, std::memory_order_relaxed);
+                full = pending->messages.size() >= config->maxBatch;
+                if (full) deliver(*pending);
+            }
+        }
+        // An entry flushed in the meantime is retired and the message goes
+        // into a fresh one behind it.
+        if (stale || full) retire(key, pending);
+        if (!stale) return true;
+    }
+}
+
+void CandidateBatcher::flushAll()
+{
+    std::unordered_map<std::string, std::shared_ptr<Pending>> pending;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        pending.swap(m_pending);
+        m_pendingPairs = 0;
+    }
+    for (auto& entry : pending) {
+        std::lock_guard<std::mutex> pairLock(entry.second->mutex);
+        deliver(*entry.second);
+    }
+}
+
+void CandidateBatcher::onTimer(const std::string& key, std::uint64_t generation)
+{
+    std::shared_ptr<Pending> pending;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        const auto it = m_pending.find(key);
+        if (it == m_pending.end() || it->second->generation != generation) return;
+        pending = it->second;
+    }
+    {
+        std::lock_guard<std::mutex> pairLock(pending->mutex);
+        deliver(*pending);
+    }
+    retire(key, pending);
+}
+
+void CandidateBatcher::deliver(Pending& pending)
+{
+    if (pending.delivered) return;
+    pending.delivered = true;
+    if (pending.timer) pending.timer->cancel();
+    if (pending.messages.empty()) return;
+    m_stats.frames.fetch_add(1, std::memory_order_relaxed);
+    if (pending.messages.size() == 1) {
+        m_handler(pending.sender, pending.receiver, pending.messages.front());
+    } else if (m_acceptsBatches(pending.receiver)) {
+        m_handler(pending.sender, pending.receiver, makeBatchFrame(pending.sender, pending.receiver, pending.messages));
+    } else {
+        for (const auto& message : pending.messages) {
+            if (!m_handler(pending.sender, pending.receiver, message)) break;
+            recordUnbatched(1);
+        }
+    }
+}
+
+void CandidateBatcher::retire(const std::string& key, const std::shared_ptr<Pending>& pending)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    const auto it = m_pending.find(key);
+    if (it == m_pending.end() || it->second != pending) return;
+    m_pending.erase(it);
+    m_pendingPairs.fetch_sub(1, std::memory_order_release);
+}
+
+std::string CandidateBatcher::makeBatchFrame(const std::string& sender, const std::string& receiver, const std::vector<std::string>& messages)
+{
+    // The held messages were parsed as JSON objects on arrival, so they are
+    // spliced into the data array verbatim rather than parsed again.
+    std::size_t size = 96 + sender.size() + receiver.size();
+    for (const auto& message : messages) size += message.size() + 1;
+    std::string frame;
+    frame.reserve(size);
+    frame += "{\"type\":\"candidateBatch\",\"data\":[";
+    for (std::size_t i = 0; i < messages.size(); ++i) {
+        if (i > 0) frame += ',';
+        frame += messages[i];
+    }
+    frame += "],\"sender\":";
+    frame += nlohmann::json(sender).dump();
+    frame += ",\"receiver\":";
+    frame += nlohmann::json(receiver).dump();
+    frame += '}';
+    return frame;
+}
@@ -0,0 +1,75 @@
+#pragma once
+
+#include "config_util.h"
+
+#include <asio/io_service.hpp>
+#include <asio/steady_timer.hpp>
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+struct CandidateBatchStats {
+    std::atomic<std::uint64_t> held{0};
+    std::atomic<std::uint64_t> frames{0};
+    std::atomic<std::uint64_t> unbatched{0};
+};
+
+// Coalesces trickle-ICE candidates per sender/receiver pair. Messages are held
+// for holdMs and delivered as one candidateBatch frame whose data array holds
+// the original messages in order. Delivery runs under the pair's own lock
+// only, so a flush never stalls relays on other pairs.
+class CandidateBatcher {
+public:
+    // Relays one frame and returns false if the receiver could not take it.
+    using FlushHandler = std::function<bool(const std::string& sender, const std::string& receiver, const std::string& frame)>;
+    // Asked again at flush time: a receiver may have gone away, or reconnected
+    // without batchCandidates, while its batch was held.
+    using BatchPredicate = std::function<bool(const std::string& receiver)>;
+
+    CandidateBatcher(asio::io_service& ioService, FlushHandler handler, BatchPredicate acceptsBatches);
+    void configure(const CandidateBatchConfig& config);
+    bool isEnabled() const { return m_enabled.load(std::memory_order_relaxed); }
+    bool isBatchedType(const std::string& type) const;
+    // Holds message when hold is true and returns true. Otherwise flushes
+    // anything pending for the pair first, so the caller's relay stays ordered
+    // behind it, and returns false.
+    bool submit(const std::string& sender, const std::string& receiver, const std::string& message, bool hold);
+    void flushAll();
+    void recordUnbatched(std::size_t count) { m_stats.unbatched.fetch_add(count, std::memory_order_relaxed); }
+    const CandidateBatchStats& getStats() const { return m_stats; }
+    static std::string makeBatchFrame(const std::string& sender, const std::string& receiver, const std::vector<std::string>& messages);
+
+private:
+    struct Pending {
+        std::mutex mutex;
+        std::string sender;
+        std::string receiver;
+        std::vector<std::string> messages;
+        std::unique_ptr<asio::steady_timer> timer;
+        std::uint64_t generation = 0;
+        bool delivered = false;
+    };
+
+    void onTimer(const std::string& key, std::uint64_t generation);
+    // Must be called with pending.mutex held. The pair stays in m_pending
+    // until retire(), so a direct relay on the same pair waits on the pair
+    // lock instead of overtaking the batch.
+    void deliver(Pending& pending);
+    void retire(const std::string& key, const std::shared_ptr<Pending>& pending);
+
+    asio::io_service& m_ioService;
+    FlushHandler m_handler;
+    BatchPredicate m_acceptsBatches;
+    std::atomic_bool m_enabled{false};
+    std::atomic<std::size_t> m_pendingPairs{0};
+    std::shared_ptr<const CandidateBatchConfig> m_config;
+    std::mutex m_mutex;
+    std::unordered_map<std::string, std::shared_ptr<Pending>> m_pending;
+    std::uint64_t m_generation = 0;
+    CandidateBatchStats m_stats;
+};
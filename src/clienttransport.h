@@ -0,0 +1,41 @@
+#pragma once
+
+#include "websocket_types.h"
+
+#include <cstddef>
+#include <string>
+#include <system_error>
+
+class ClientTransport {
+public:
+    virtual ~ClientTransport() = default;
+    virtual void send(const ConnectionHandle& handle, const std::string& message, std::error_code& error) = 0;
+    virtual void close(const ConnectionHandle& handle, websocketpp::close::status::value code, const std::string& reason, std::error_code& error) = 0;
+    virtual std::size_t bufferedAmount(const ConnectionHandle& handle) = 0;
+};
+
+template <typename Endpoint>
+class WebsocketppTransport : public ClientTransport {
+public:
+    explicit WebsocketppTransport(Endpoint& endpoint) : m_endpoint(endpoint) {}
+
+    void send(const ConnectionHandle& handle, const std::string& message, std::error_code& error) override
+    {
+        m_endpoint.send(handle, message, websocketpp::frame::opcode::text, error);
+    }
+
+    void close(const ConnectionHandle& handle, websocketpp::close::status::value code, const std::string& reason, std::error_code& error) override
+    {
+        m_endpoint.close(handle, code, reason, error);
+    }
+
+    std::size_t bufferedAmount(const ConnectionHandle& handle) override
+    {
+        websocketpp::lib::error_code error;
+        const auto connection = m_endpoint.get_con_from_hdl(handle, error);
+        return error || !connection ? 0 : connection->get_buffered_amount();
+    }
+
+private:
+    Endpoint& m_endpoint;
+};
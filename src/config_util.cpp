@@ -3,8 +3,72 @@
 #include <algorithm>
 #include <cctype>
 #include <fstream>
+#include <sstream>
 #include <unordered_map>
 
+namespace {
+using ConfigValues = std::unordered_map<std::string, std::string>;
+
+std::string lowerCase(std::string value)
+{
+    std::transform(value.begin(), value.end(), value.begin(), [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+    return value;
+}
+
+void readPort(const ConfigValues& values, const std::string& key, std::uint16_t& target)
+{
+    const auto it = values.find(key);
+    if (it == values.end()) return;
+    try {
+        const auto port = std::stoul(it->second);
+        if (port <= 65535) target = static_cast<std::uint16_t>(port);
+    } catch (...) {}
+}
+
+template <typename T>
+void readUnsigned(const ConfigValues& values, const std::string& key, T& target)
+{
+    const auto it = values.find(key);
+    if (it == values.end()) return;
+    try {
+        const auto value = std::stoll(it->second);
+        if (value >= 0) target = static_cast<T>(value);
+    } catch (...) {}
+}
+
+void readBool(const ConfigValues& values, const std::string& key, bool& target)
+{
+    const auto it = values.find(key);
+    if (it == values.end()) return;
+    const auto value = lowerCase(it->second);
+    if (value == "true" || value == "1" || value == "yes" || value == "on") target = true;
+    else if (value == "false" || value == "0" || value == "no" || value == "off") target = false;
+}
+
+void readDouble(const ConfigValues& values, const std::string& key, double& target)
+{
+    const auto it = values.find(key);
+    if (it == values.end()) return;
+    try {
+        const auto value = std::stod(it->second);
+        if (value >= 0) target = value;
+    } catch (...) {}
+}
+
+void readList(const ConfigValues& values, const std::string& key, std::vector<std::string>& target)
+{
+    const auto it = values.find(key);
+    if (it == values.end()) return;
+    target.clear();
+    std::istringstream input(it->second);
+    std::string item;
+    while (std::getline(input, item, ',')) {
+        const auto first = item.find_first_not_of(" \t");
+        if (first != std::string::npos) target.push_back(item.substr(first, item.find_last_not_of(" \t") - first + 1));
+    }
+}
+}
+
 ConfigUtilData* ConfigUtilData::getInstance()
 {
     static ConfigUtilData instance;
@@ -15,7 +79,7 @@ void ConfigUtilData::load(const std::filesystem::path& applicationDir)
 {
     filePath = applicationDir / "config.ini";
     std::ifstream input(filePath);
-    std::unordered_map<std::string, std::string> values;
+    ConfigValues values;
     std::string section;
     std::string line;
     while (std::getline(input, line)) {
@@ -37,20 +101,73 @@ void ConfigUtilData::load(const std::filesystem::path& applicationDir)
         values[section + "." + key] = value;
     }
 
-    if (auto it = values.find("signal_server.serverPort"); it != values.end()) {
-        try {
-            const auto port = std::stoul(it->second);
-            if (port <= 65535) serverPort = static_cast<std::uint16_t>(port);
-        } catch (...) {}
-    }
+    readPort(values, "signal_server.serverPort", serverPort);
     if (auto it = values.find("signal_server.serverName"); it != values.end() && !it->second.empty()) serverName = it->second;
 
-    auto level = values.count("local.logLevel") ? values["local.logLevel"] : "info";
-    std::transform(level.begin(), level.end(), level.begin(), [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+    const auto level = lowerCase(values.count("local.logLevel") ? values["local.logLevel"] : "info");
     if (level == "trace") logLevel = spdlog::level::trace;
     else if (level == "debug") logLevel = spdlog::level::debug;
     else if (level == "warn") logLevel = spdlog::level::warn;
     else if (level == "error") logLevel = spdlog::level::err;
     else if (level == "critical") logLevel = spdlog::level::critical;
     else logLevel = spdlog::level::info;
+
+    if (auto it = values.find("transport.engine"); it != values.end() && !it->second.empty()) transport.engine = lowerCase(it->second);
+    readUnsigned(values, "transport.maxConnections", transport.maxConnections);
+    readBool(values, "transport.tcpNoDelay", transport.tcpNoDelay);
+    readUnsigned(values, "transport.sendBufferSize", transport.sendBufferSize);
+    readUnsigned(values, "transport.receiveBufferSize", transport.receiveBufferSize);
+    readUnsigned(values, "transport.listenBacklog", transport.listenBacklog);
+    readUnsigned(values, "transport.maxMessageSize", transport.maxMessageSize);
+    readUnsigned(values, "transport.openHandshakeTimeoutMs", transport.openHandshakeTimeoutMs);
+    readUnsigned(values, "transport.closeHandshakeTimeoutMs", transport.closeHandshakeTimeoutMs);
+    readUnsigned(values, "transport.workerThreads", transport.workerThreads);
+
+    readDouble(values, "rate_limit.messagesPerSecond", rateLimit.messagesPerSecond);
+    readDouble(values, "rate_limit.burst", rateLimit.burst);
+    readDouble(values, "rate_limit.receiverMessagesPerSecond", rateLimit.receiverMessagesPerSecond);
+    readDouble(values, "rate_limit.receiverBurst", rateLimit.receiverBurst);
+    const auto penalty = lowerCase(values.count("rate_limit.penalty") ? values["rate_limit.penalty"] : "drop");
+    if (penalty == "error") rateLimit.penalty = RateLimitPenalty::Error;
+    else if (penalty == "disconnect") rateLimit.penalty = RateLimitPenalty::Disconnect;
+    else rateLimit.penalty = RateLimitPenalty::Drop;
+
+    readBool(values, "store_forward.enabled", storeForward.enabled);
+    readUnsigned(values, "store_forward.ttlMs", storeForward.ttlMs);
+    readUnsigned(values, "store_forward.maxMessagesPerSession", storeForward.maxMessagesPerSession);
+    readUnsigned(values, "store_forward.maxBytes", storeForward.maxBytes);
+
+    readBool(values, "candidate_batch.enabled", candidateBatch.enabled);
+    readUnsigned(values, "candidate_batch.holdMs", candidateBatch.holdMs);
+    readUnsigned(values, "candidate_batch.maxBatch", candidateBatch.maxBatch);
+    readList(values, "candidate_batch.types", candidateBatch.types);
+
+    readBool(values, "call_trace.enabled", callTrace.enabled);
+    readDouble(values, "call_trace.sampleRate", callTrace.sampleRate);
+    if (auto it = values.find("call_trace.directory"); it != values.end() && !it->second.empty()) callTrace.directory = it->second;
+    readUnsigned(values, "call_trace.timeoutMs", callTrace.timeoutMs);
+    readUnsigned(values, "call_trace.maxActiveCalls", callTrace.maxActiveCalls);
+    readUnsigned(values, "call_trace.maxSpansPerCall", callTrace.maxSpansPerCall);
+    readList(values, "call_trace.offerTypes", callTrace.offerTypes);
+    readList(values, "call_trace.answerTypes", callTrace.answerTypes);
+    readList(values, "call_trace.candidateTypes", callTrace.candidateTypes);
+    readList(values, "call_trace.connectedTypes", callTrace.connectedTypes);
+
+    readBool(values, "capture.enabled", capture.enabled);
+    if (auto it = values.find("capture.file"); it != values.end() && !it->second.empty()) capture.file = it->second;
+    readBool(values, "capture.payloads", capture.payloads);
+
+    readBool(values, "tls.enabled", tls.enabled);
+    readPort(values, "tls.port", tls.port);
+    if (auto it = values.find("tls.certificateFile"); it != values.end() && !it->second.empty()) tls.certificateFile = it->second;
+    if (auto it = values.find("tls.privateKeyFile"); it != values.end() && !it->second.empty()) tls.privateKeyFile = it->second;
+    if (auto it = values.find("tls.ciphers"); it != values.end()) tls.ciphers = it->second;
+    readUnsigned(values, "tls.sessionCacheSize", tls.sessionCacheSize);
+    readUnsigned(values, "tls.sessionTimeoutSec", tls.sessionTimeoutSec);
+    readBool(values, "tls.sessionTickets", tls.sessionTickets);
+    if (auto it = values.find("tls.ticketKeyFile"); it != values.end()) tls.ticketKeyFile = it->second;
+
+    if (auto it = values.find("admin.address"); it != values.end() && !it->second.empty()) admin.address = it->second;
+    readPort(values, "admin.port", admin.port);
+    if (auto it = values.find("admin.token"); it != values.end()) admin.token = it->second;
 }
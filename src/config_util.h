@@ -1,12 +1,88 @@
 #pragma once
 
+#include <cstddef>
 #include <cstdint>
 #include <filesystem>
 #include <string>
+#include <vector>
 #include <spdlog/spdlog.h>
 
 #define ConfigUtil ConfigUtilData::getInstance()
 
+enum class RateLimitPenalty { Drop, Error, Disconnect };
+
+struct RateLimitConfig {
+    double messagesPerSecond = 0;
+    double burst = 200;
+    double receiverMessagesPerSecond = 0;
+    double receiverBurst = 200;
+    RateLimitPenalty penalty = RateLimitPenalty::Drop;
+};
+
+struct TransportConfig {
+    std::string engine = "websocketpp";
+    std::size_t maxConnections = 65536;
+    bool tcpNoDelay = true;
+    int sendBufferSize = 0;
+    int receiveBufferSize = 0;
+    int listenBacklog = 0;
+    std::size_t maxMessageSize = 32000000;
+    long openHandshakeTimeoutMs = 5000;
+    long closeHandshakeTimeoutMs = 5000;
+    unsigned workerThreads = 1;
+};
+
+struct StoreForwardConfig {
+    bool enabled = false;
+    long ttlMs = 5000;
+    std::size_t maxMessagesPerSession = 64;
+    std::size_t maxBytes = 16 * 1024 * 1024;
+};
+
+struct CandidateBatchConfig {
+    bool enabled = false;
+    long holdMs = 5;
+    std::size_t maxBatch = 32;
+    std::vector<std::string> types{"candidate"};
+};
+
+struct CallTraceConfig {
+    bool enabled = false;
+    double sampleRate = 0.01;
+    std::string directory = "call_traces";
+    long timeoutMs = 30000;
+    std::size_t maxActiveCalls = 10000;
+    std::size_t maxSpansPerCall = 2000;
+    std::vector<std::string> offerTypes{"offer"};
+    std::vector<std::string> answerTypes{"answer"};
+    std::vector<std::string> candidateTypes{"candidate", "candidateBatch"};
+    std::vector<std::string> connectedTypes{"connected"};
+};
+
+struct CaptureConfig {
+    bool enabled = false;
+    std::string file = "captures/signal_server.sstrace";
+    bool payloads = false;
+};
+
+struct TlsConfig {
+    bool enabled = false;
+    std::uint16_t port = 8443;
+    std::string certificateFile = "certs/server.crt";
+    std::string privateKeyFile = "certs/server.key";
+    std::string ciphers;
+    std::size_t sessionCacheSize = 20480;
+    long sessionTimeoutSec = 7200;
+    bool sessionTickets = true;
+    std::string ticketKeyFile;
+};
+
+struct AdminConfig {
+    std::string address = "127.0.0.1";
+    std::uint16_t port = 0;
+    std::string token;
+};
+
 class ConfigUtilData {
 public:
     static ConfigUtilData* getInstance();
@@ -16,6 +92,14 @@ public:
     std::uint16_t serverPort = 8080;
     std::string serverName = "Signal Server";
     spdlog::level::level_enum logLevel = spdlog::level::info;
+    TransportConfig transport;
+    RateLimitConfig rateLimit;
+    AdminConfig admin;
+    TlsConfig tls;
+    StoreForwardConfig storeForward;
+    CandidateBatchConfig candidateBatch;
+    CallTraceConfig callTrace;
+    CaptureConfig capture;
 
 private:
     ConfigUtilData() = default;
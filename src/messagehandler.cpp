@@ -3,23 +3,108 @@
 #include "websocketclient.h"
 #include "websocketserver.h"
 
-void MessageHandler::handleMessage(WebSocketClient* client, const std::string& message)
+void MessageHandler::handleMessage(WebSocketClient* client, const std::string& message, std::int64_t receivedNs, std::int64_t dispatchNs)
 {
+    const auto handlerStartNs = dispatchNs ? CallTracer::nowNs() : 0;
     LOG_DEBUG("Message from {}: {}", client->getSessionId(), message);
-    if (message == "@heart") return;
+    auto& capture = m_server->getTraceCapture();
+    if (message == "@heart") {
+        if (capture.isEnabled()) capture.recordMessage(client->getSessionId(), {}, message);
+        return;
+    }
     const auto parsed = WsMsg::fromJsonString(message);
+    if (capture.isEnabled()) capture.recordMessage(client->getSessionId(), parsed.getReceiver(), message);
     if (parsed.getType().empty()) {
         client->sendMessage(WsMsg("error", "Invalid message format", "server", client->getSessionId()).toJsonString());
         return;
     }
+    if (parsed.getType() == "presenceQuery") {
+        handlePresenceQuery(client, parsed);
+        return;
+    }
     handleSignalMessage(client, parsed, message);
+    auto& tracer = m_server->getCallTracer();
+    if (dispatchNs && tracer.isTraced(client->getSessionId(), parsed.getReceiver())) {
+        tracer.record(client->getSessionId(), parsed.getReceiver(), parsed.getType(), receivedNs, dispatchNs, handlerStartNs, CallTracer::nowNs());
+    }
+}
+
+void MessageHandler::handlePresenceQuery(WebSocketClient* client, const WsMsg& message)
+{
+    if (!message.getData().is_array()) {
+        client->sendMessage(WsMsg("error", "Invalid presence query", "server", client->getSessionId()).toJsonString());
+        return;
+    }
+    if (message.getData().size() > kMaxPresenceQuery) {
+        const auto error = "Presence query exceeds " + std::to_string(kMaxPresenceQuery) + " SNs";
+        client->sendMessage(WsMsg("error", error, "server", client->getSessionId()).toJsonString());
+        return;
+    }
+    std::vector<std::string> sns;
+    sns.reserve(message.getData().size());
+    for (const auto& sn : message.getData()) {
+        if (sn.is_string()) sns.push_back(sn.get<std::string>());
+    }
+    auto presence = m_server->getUserManager().queryPresence(sns);
+    nlohmann::json result = nlohmann::json::array();
+    result.get_ref<nlohmann::json::array_t&>().reserve(presence.size());
+    for (auto& entry : presence) {
+        nlohmann::json item(nlohmann::json::value_t::object);
+        item["sn"] = std::move(entry.sn);
+        item["online"] = entry.online;
+        item["loginDate"] = std::move(entry.loginDate);
+        result.push_back(std::move(item));
+    }
+    nlohmann::json response = {{"type", "presenceResult"}, {"sender", "server"}, {"receiver", client->getSessionId()}};
+    response["data"] = std::move(result);
+    client->sendMessage(response.dump());
 }
 
 void MessageHandler::handleSignalMessage(WebSocketClient* client, const WsMsg& message, const std::string& original)
 {
     if (message.getReceiver().empty()) {
         client->sendMessage(WsMsg::createErrorNotFoundMsg(message.getSender()).toJsonString());
-    } else if (!m_server->sendMessageToClient(message.getReceiver(), original)) {
+        return;
+    }
+    auto& batcher = m_server->getCandidateBatcher();
+    if (batcher.isEnabled()) {
+        const bool hold = batcher.isBatchedType(message.getType()) && m_server->acceptsCandidateBatches(message.getReceiver());
+        if (batcher.submit(client->getSessionId(), message.getReceiver(), original, hold)) return;
+    }
+    if (message.getType() == "candidateBatch") handleCandidateBatch(client, message, original);
+    else relay(client, message, original);
+}
+
+void MessageHandler::handleCandidateBatch(WebSocketClient* client, const WsMsg& message, const std::string& original)
+{
+    if (!message.getData().is_array()) {
+        client->sendMessage(WsMsg("error", "Invalid candidate batch", "server", client->getSessionId()).toJsonString());
+        return;
+    }
+    if (m_server->acceptsCandidateBatches(message.getReceiver())) {
+        relay(client, message, original);
+        return;
+    }
+    auto& batcher = m_server->getCandidateBatcher();
+    for (const auto& item : message.getData()) {
+        if (!relay(client, message, item.dump())) return;
+        batcher.recordUnbatched(1);
+    }
+}
+
+bool MessageHandler::relay(WebSocketClient* client, const WsMsg& message, const std::string& payload)
+{
+    switch (m_server->relayMessage(message.getReceiver(), payload, client->getSessionId())) {
+    case WebSocketServer::RelayResult::Sent:
+    case WebSocketServer::RelayResult::Queued:
+        return true;
+    case WebSocketServer::RelayResult::Offline:
         client->sendMessage(WsMsg::createOfflineMsg(message.getSender()).toJsonString());
+        return false;
+    case WebSocketServer::RelayResult::RateLimited:
+        // The receiver is being flooded, not necessarily by this sender, so the
+        // message is only dropped and counted in receiverDropped.
+        return false;
     }
+    return false;
 }
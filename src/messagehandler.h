@@ -1,6 +1,7 @@
 #pragma once
 
 #include "wsmsg.h"
+#include <cstdint>
 #include <string>
 
 class WebSocketClient;
@@ -9,9 +10,18 @@ class WebSocketServer;
 class MessageHandler {
 public:
     explicit MessageHandler(WebSocketServer* server) : m_server(server) {}
-    void handleMessage(WebSocketClient* client, const std::string& message);
+    // receivedNs is when the transport read the frame and dispatchNs when the
+    // server picked it up; both are 0 when call tracing is off.
+    void handleMessage(WebSocketClient* client, const std::string& message, std::int64_t receivedNs, std::int64_t dispatchNs);
 
 private:
+    // One frame may list at most this many SNs, so a single query cannot
+    // force an arbitrarily large lookup and reply.
+    static constexpr std::size_t kMaxPresenceQuery = 1000;
+
     WebSocketServer* m_server;
     void handleSignalMessage(WebSocketClient* client, const WsMsg& message, const std::string& original);
+    void handlePresenceQuery(WebSocketClient* client, const WsMsg& message);
+    void handleCandidateBatch(WebSocketClient* client, const WsMsg& message, const std::string& original);
+    bool relay(WebSocketClient* client, const WsMsg& message, const std::string& payload);
 };
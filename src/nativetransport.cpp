@@ -0,0 +1,702 @@
+#include "nativetransport.h"
+#include "logger_manager.h"
+
+#include <websocketpp/base64/base64.hpp>
+#include <websocketpp/sha1/sha1.hpp>
+
+#include <algorithm>
+#include <arpa/inet.h>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+namespace {
+using Clock = std::chrono::steady_clock;
+
+constexpr std::size_t kSlotBufferSize = 4096;
+constexpr std::uint64_t kListenTag = ~0ULL;
+constexpr std::uint64_t kWakeTag = ~0ULL - 1;
+constexpr std::uint8_t kOpContinuation = 0x0;
+constexpr std::uint8_t kOpText = 0x1;
+constexpr std::uint8_t kOpBinary = 0x2;
+constexpr std::uint8_t kOpClose = 0x8;
+constexpr std::uint8_t kOpPing = 0x9;
+constexpr std::uint8_t kOpPong = 0xA;
+
+enum class SlotState { Free, Handshake, Open, Closing };
+
+void unmask(char* data, std::size_t size, const char* key)
+{
+    std::uint32_t key32;
+    std::memcpy(&key32, key, sizeof(key32));
+    const std::uint64_t key64 = (static_cast<std::uint64_t>(key32) << 32) | key32;
+    std::size_t i = 0;
+    for (; i + 8 <= size; i += 8) {
+        std::uint64_t word;
+        std::memcpy(&word, data + i, sizeof(word));
+        word ^= key64;
+        std::memcpy(data + i, &word, sizeof(word));
+    }
+    for (; i < size; ++i) data[i] ^= key[i & 3];
+}
+
+std::size_t encodeHeader(char* header, std::uint8_t opcode, std::size_t size)
+{
+    header[0] = static_cast<char>(0x80 | opcode);
+    if (size < 126) {
+        header[1] = static_cast<char>(size);
+        return 2;
+    }
+    if (size <= 0xFFFF) {
+        header[1] = 126;
+        header[2] = static_cast<char>(size >> 8);
+        header[3] = static_cast<char>(size);
+        return 4;
+    }
+    header[1] = 127;
+    for (int i = 0; i < 8; ++i) header[2 + i] = static_cast<char>(static_cast<std::uint64_t>(size) >> (56 - 8 * i));
+    return 10;
+}
+
+std::string lowerCase(std::string value)
+{
+    std::transform(value.begin(), value.end(), value.begin(), [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+    return value;
+}
+
+std::string formatAddress(const sockaddr_storage& address)
+{
+    char text[INET6_ADDRSTRLEN] = {};
+    if (address.ss_family == AF_INET6) {
+        const auto& v6 = reinterpret_cast<const sockaddr_in6&>(address);
+        inet_ntop(AF_INET6, &v6.sin6_addr, text, sizeof(text));
+        return "[" + std::string(text) + "]:" + std::to_string(ntohs(v6.sin6_port));
+    }
+    const auto& v4 = reinterpret_cast<const sockaddr_in&>(address);
+    inet_ntop(AF_INET, &v4.sin_addr, text, sizeof(text));
+    return std::string(text) + ":" + std::to_string(ntohs(v4.sin_port));
+}
+
+int createListenSocket(std::uint16_t port, int backlog)
+{
+    int fd = socket(AF_INET6, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    const int on = 1;
+    const int off = 0;
+    if (fd != -1) {
+        setsockopt(fd, IPPROTO_IPV6, IPV6_V6ONLY, &off, sizeof(off));
+        setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &on, sizeof(on));
+        setsockopt(fd, SOL_SOCKET, SO_REUSEPORT, &on, sizeof(on));
+        sockaddr_in6 address{};
+        address.sin6_family = AF_INET6;
+        address.sin6_addr = in6addr_any;
+        address.sin6_port = htons(port);
+        if (bind(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) == 0 && ::listen(fd, backlog) == 0) return fd;
+        ::close(fd);
+    }
+    fd = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (fd == -1) return -1;
+    setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &on, sizeof(on));
+    setsockopt(fd, SOL_SOCKET, SO_REUSEPORT, &on, sizeof(on));
+    sockaddr_in address{};
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_ANY);
+    address.sin_port = htons(port);
+    if (bind(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) == 0 && ::listen(fd, backlog) == 0) return fd;
+    ::close(fd);
+    return -1;
+}
+}
+
+struct NativeTransport::Slot {
+    struct Token {
+        Slot* slot;
+        std::uint32_t generation;
+    };
+
+    // Owned by the loop thread.
+    int epollFd = -1;
+    std::uint32_t index = 0;
+    char* buffer = nullptr;
+    std::size_t used = 0;
+    std::string overflow;
+    bool inOverflow = false;
+    std::string fragments;
+    bool fragmenting = false;
+    bool fragmentIsText = false;
+    std::size_t maxMessageSize = 0;
+    std::shared_ptr<Token> token;
+    std::string remoteAddress;
+    // steady_clock time of the recv() that completed the frames being parsed.
+    std::int64_t receivedNs = 0;
+
+    // Shared with sending threads, guarded by writeMutex.
+    std::mutex writeMutex;
+    int fd = -1;
+    std::uint32_t generation = 0;
+    std::atomic<SlotState> state{SlotState::Free};
+    Clock::time_point stateSince;
+    std::string pending;
+    std::size_t pendingOffset = 0;
+    bool writeArmed = false;
+    bool shutdownAfterFlush = false;
+
+    std::uint64_t eventData() const { return (static_cast<std::uint64_t>(generation) << 32) | index; }
+    char* data() { return inOverflow ? &overflow[0] : buffer; }
+    std::size_t capacity() const { return inOverflow ? overflow.size() : kSlotBufferSize; }
+};
+
+struct NativeTransport::Loop {
+    int epollFd = -1;
+    int listenFd = -1;
+    int wakeFd = -1;
+    std::unique_ptr<Slot[]> slots;
+    std::size_t slotCount = 0;
+    std::vector<std::uint32_t> freeSlots;
+};
+
+namespace {
+void armWrite(int epollFd, int fd, std::uint64_t data, bool enable)
+{
+    epoll_event event{};
+    event.events = EPOLLIN | EPOLLRDHUP | (enable ? static_cast<std::uint32_t>(EPOLLOUT) : 0u);
+    event.data.u64 = data;
+    epoll_ctl(epollFd, EPOLL_CTL_MOD, fd, &event);
+}
+}
+
+NativeTransport::NativeTransport(const TransportConfig& config, Callbacks callbacks)
+    : m_config(config), m_callbacks(std::move(callbacks)) {}
+
+NativeTransport::~NativeTransport()
+{
+    stop();
+    join();
+    for (auto& loop : m_loops) {
+        for (std::size_t i = 0; i < loop->slotCount; ++i) {
+            if (loop->slots[i].fd != -1) ::close(loop->slots[i].fd);
+        }
+        if (loop->listenFd != -1) ::close(loop->listenFd);
+        if (loop->wakeFd != -1) ::close(loop->wakeFd);
+        if (loop->epollFd != -1) ::close(loop->epollFd);
+    }
+    if (m_buffers) munmap(m_buffers, m_buffersSize);
+}
+
+bool NativeTransport::listen(std::uint16_t port)
+{
+    const auto config = currentConfig();
+    std::size_t loopCount = config.workerThreads == 0 ? std::max(1u, std::thread::hardware_concurrency()) : config.workerThreads;
+    // Slots are not shared between loops: SO_REUSEPORT picks the loop, and a
+    // full loop rejects even while others still have free slots.
+    const std::size_t slotsPerLoop = std::max<std::size_t>(1, (config.maxConnections + loopCount - 1) / loopCount);
+    m_buffersSize = slotsPerLoop * loopCount * kSlotBufferSize;
+    void* buffers = mmap(nullptr, m_buffersSize, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+    if (buffers == MAP_FAILED) {
+        LOG_ERROR("Unable to reserve {} bytes of connection buffers: {}", m_buffersSize, std::strerror(errno));
+        return false;
+    }
+    m_buffers = static_cast<char*>(buffers);
+
+    const int backlog = config.listenBacklog > 0 ? config.listenBacklog : SOMAXCONN;
+    for (std::size_t i = 0; i < loopCount; ++i) {
+        auto loop = std::make_unique<Loop>();
+        loop->listenFd = createListenSocket(port, backlog);
+        loop->epollFd = epoll_create1(EPOLL_CLOEXEC);
+        loop->wakeFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+        if (loop->listenFd == -1 || loop->epollFd == -1 || loop->wakeFd == -1) {
+            LOG_ERROR("Unable to listen on port {}: {}", port, std::strerror(errno));
+            m_loops.push_back(std::move(loop));
+            return false;
+        }
+        epoll_event event{};
+        event.events = EPOLLIN;
+        event.data.u64 = kListenTag;
+        epoll_ctl(loop->epollFd, EPOLL_CTL_ADD, loop->listenFd, &event);
+        event.data.u64 = kWakeTag;
+        epoll_ctl(loop->epollFd, EPOLL_CTL_ADD, loop->wakeFd, &event);
+
+        loop->slotCount = slotsPerLoop;
+        loop->slots = std::make_unique<Slot[]>(slotsPerLoop);
+        loop->freeSlots.reserve(slotsPerLoop);
+        for (std::size_t index = 0; index < slotsPerLoop; ++index) {
+            auto& slot = loop->slots[index];
+            slot.index = static_cast<std::uint32_t>(index);
+            slot.epollFd = loop->epollFd;
+            slot.buffer = m_buffers + (i * slotsPerLoop + index) * kSlotBufferSize;
+            loop->freeSlots.push_back(static_cast<std::uint32_t>(slotsPerLoop - 1 - index));
+        }
+        m_loops.push_back(std::move(loop));
+    }
+    LOG_INFO("Native transport: {} epoll loop(s), {} connection slots", loopCount, slotsPerLoop * loopCount);
+    return true;
+}
+
+void NativeTransport::start()
+{
+    if (m_running.exchange(true)) return;
+    for (auto& loop : m_loops) m_threads.emplace_back([this, &loop] { runLoop(*loop); });
+}
+
+void NativeTransport::stop()
+{
+    if (!m_running.exchange(false)) return;
+    for (auto& loop : m_loops) {
+        const std::uint64_t value = 1;
+        if (write(loop->wakeFd, &value, sizeof(value)) < 0) LOG_DEBUG("Unable to wake native transport loop");
+    }
+}
+
+void NativeTransport::join()
+{
+    for (auto& thread : m_threads) {
+        if (thread.joinable()) thread.join();
+    }
+    m_threads.clear();
+}
+
+void NativeTransport::setTransportConfig(const TransportConfig& config)
+{
+    std::lock_guard<std::mutex> lock(m_configMutex);
+    m_config = config;
+}
+
+TransportConfig NativeTransport::currentConfig() const
+{
+    std::lock_guard<std::mutex> lock(m_configMutex);
+    return m_config;
+}
+
+void NativeTransport::runLoop(Loop& loop)
+{
+    epoll_event events[256];
+    auto lastSweep = Clock::now();
+    while (m_running) {
+        const int count = epoll_wait(loop.epollFd, events, 256, 1000);
+        if (count < 0 && errno != EINTR) {
+            LOG_ERROR("epoll_wait failed: {}", std::strerror(errno));
+            break;
+        }
+        for (int i = 0; i < count; ++i) {
+            const auto data = events[i].data.u64;
+            if (data == kListenTag) {
+                acceptConnections(loop);
+                continue;
+            }
+            if (data == kWakeTag) {
+                std::uint64_t value;
+                while (read(loop.wakeFd, &value, sizeof(value)) > 0) {}
+                continue;
+            }
+            auto& slot = loop.slots[static_cast<std::uint32_t>(data)];
+            if (slot.eventData() != data || slot.state == SlotState::Free) continue;
+            const auto flags = events[i].events;
+            if (flags & (EPOLLIN | EPOLLRDHUP | EPOLLHUP | EPOLLERR)) readSlot(loop, slot);
+            if ((flags & EPOLLOUT) && slot.eventData() == data && slot.state != SlotState::Free) flushSlot(slot);
+        }
+        const auto now = Clock::now();
+        if (now - lastSweep >= std::chrono::seconds(1)) {
+            sweepTimeouts(loop);
+            lastSweep = now;
+        }
+    }
+    for (std::size_t i = 0; i < loop.slotCount; ++i) {
+        if (loop.slots[i].state != SlotState::Free) closeSlot(loop, loop.slots[i]);
+    }
+}
+
+void NativeTransport::acceptConnections(Loop& loop)
+{
+    const auto config = currentConfig();
+    while (true) {
+        sockaddr_storage address{};
+        socklen_t length = sizeof(address);
+        const int fd = accept4(loop.listenFd, reinterpret_cast<sockaddr*>(&address), &length, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (fd == -1) {
+            if (errno == EINTR || errno == ECONNABORTED) continue;
+            if (errno != EAGAIN && errno != EWOULDBLOCK) LOG_WARN("accept failed: {}", std::strerror(errno));
+            return;
+        }
+        if (loop.freeSlots.empty()) {
+            LOG_WARN("Native transport out of connection slots on this loop ({} per loop), rejecting {}", loop.slotCount, formatAddress(address));
+            ::close(fd);
+            continue;
+        }
+        const int noDelay = config.tcpNoDelay ? 1 : 0;
+        setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &noDelay, sizeof(noDelay));
+        if (config.sendBufferSize > 0) setsockopt(fd, SOL_SOCKET, SO_SNDBUF, &config.sendBufferSize, sizeof(config.sendBufferSize));
+        if (config.receiveBufferSize > 0) setsockopt(fd, SOL_SOCKET, SO_RCVBUF, &config.receiveBufferSize, sizeof(config.receiveBufferSize));
+
+        auto& slot = loop.slots[loop.freeSlots.back()];
+        loop.freeSlots.pop_back();
+        {
+            std::lock_guard<std::mutex> lock(slot.writeMutex);
+            slot.fd = fd;
+            slot.state = SlotState::Handshake;
+            slot.stateSince = Clock::now();
+            slot.token = std::make_shared<Slot::Token>(Slot::Token{&slot, slot.generation});
+        }
+        slot.used = 0;
+        slot.maxMessageSize = config.maxMessageSize;
+        slot.remoteAddress = formatAddress(address);
+        epoll_event event{};
+        event.events = EPOLLIN | EPOLLRDHUP;
+        event.data.u64 = slot.eventData();
+        epoll_ctl(loop.epollFd, EPOLL_CTL_ADD, fd, &event);
+    }
+}
+
+void NativeTransport::readSlot(Loop& loop, Slot& slot)
+{
+    while (true) {
+        const auto space = slot.capacity() - slot.used;
+        if (space == 0) {
+            closeSlot(loop, slot);
+            return;
+        }
+        const auto received = recv(slot.fd, slot.data() + slot.used, space, 0);
+        if (received == 0) {
+            closeSlot(loop, slot);
+            return;
+        }
+        if (received < 0) {
+            if (errno == EINTR) continue;
+            if (errno != EAGAIN && errno != EWOULDBLOCK) closeSlot(loop, slot);
+            return;
+        }
+        slot.used += static_cast<std::size_t>(received);
+        slot.receivedNs = std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now().time_since_epoch()).count();
+        const bool ok = slot.state == SlotState::Handshake ? processHandshake(slot) : processFrames(slot);
+        if (!ok) {
+            closeSlot(loop, slot);
+            return;
+        }
+        if (static_cast<std::size_t>(received) < space) return;
+    }
+}
+
+bool NativeTransport::processHandshake(Slot& slot)
+{
+    const std::string_view request(slot.buffer, slot.used);
+    const auto end = request.find("\r\n\r\n");
+    if (end == std::string_view::npos) return slot.used < kSlotBufferSize;
+
+    std::string resource;
+    std::string key;
+    bool upgrade = false;
+    std::size_t lineStart = 0;
+    while (lineStart < end) {
+        const auto lineEnd = request.find("\r\n", lineStart);
+        const auto line = request.substr(lineStart, lineEnd - lineStart);
+        lineStart = lineEnd + 2;
+        if (resource.empty()) {
+            if (line.substr(0, 4) != "GET ") return false;
+            const auto space = line.find(' ', 4);
+            if (space == std::string_view::npos) return false;
+            resource = std::string(line.substr(4, space - 4));
+            continue;
+        }
+        const auto colon = line.find(':');
+        if (colon == std::string_view::npos) continue;
+        const auto name = lowerCase(std::string(line.substr(0, colon)));
+        auto value = line.substr(colon + 1);
+        while (!value.empty() && (value.front() == ' ' || value.front() == '\t')) value.remove_prefix(1);
+        while (!value.empty() && (value.back() == ' ' || value.back() == '\t')) value.remove_suffix(1);
+        if (name == "sec-websocket-key") key = std::string(value);
+        else if (name == "upgrade") upgrade = lowerCase(std::string(value)) == "websocket";
+    }
+
+    std::unique_lock<std::mutex> lock(slot.writeMutex);
+    if (resource.empty() || key.empty() || !upgrade) {
+        static const std::string badRequest = "HTTP/1.1 400 Bad Request\r\nContent-Length: 0\r\nConnection: close\r\n\r\n";
+        ::send(slot.fd, badRequest.data(), badRequest.size(), MSG_NOSIGNAL | MSG_DONTWAIT);
+        return false;
+    }
+    const auto accept = key + "258EAFA5-E914-47DA-95CA-C5AB0DC85B11";
+    unsigned char digest[20];
+    websocketpp::sha1::calc(accept.data(), accept.size(), digest);
+    const auto response = "HTTP/1.1 101 Switching Protocols\r\nUpgrade: websocket\r\nConnection: Upgrade\r\nSec-WebSocket-Accept: "
+        + websocketpp::base64_encode(digest, sizeof(digest)) + "\r\n\r\n";
+    slot.pending.append(response);
+    slot.state = SlotState::Open;
+    flushSlotLocked(slot);
+    lock.unlock();
+
+    const auto consumed = end + 4;
+    std::memmove(slot.buffer, slot.buffer + consumed, slot.used - consumed);
+    slot.used -= consumed;
+    m_callbacks.onOpen(slot.token, resource, slot.remoteAddress);
+    return slot.used == 0 || processFrames(slot);
+}
+
+bool NativeTransport::processFrames(Slot& slot)
+{
+    std::size_t offset = 0;
+    while (slot.state == SlotState::Open) {
+        auto* frame = reinterpret_cast<unsigned char*>(slot.data() + offset);
+        const auto available = slot.used - offset;
+        if (available < 2) break;
+        const bool fin = frame[0] & 0x80;
+        const std::uint8_t opcode = frame[0] & 0x0F;
+        if ((frame[0] & 0x70) || !(frame[1] & 0x80)) return false;
+        std::uint64_t length = frame[1] & 0x7F;
+        std::size_t header = 2;
+        if (length == 126) {
+            if (available < 4) break;
+            length = (static_cast<std::uint64_t>(frame[2]) << 8) | frame[3];
+            header = 4;
+        } else if (length == 127) {
+            if (available < 10) break;
+            length = 0;
+            for (int i = 0; i < 8; ++i) length = (length << 8) | frame[2 + i];
+            header = 10;
+        }
+        header += 4;
+        if (opcode >= kOpClose && (length > 125 || !fin)) return false;
+        if (length > slot.maxMessageSize) {
+            char payload[2] = {static_cast<char>(websocketpp::close::status::message_too_big >> 8),
+                static_cast<char>(websocketpp::close::status::message_too_big & 0xFF)};
+            std::lock_guard<std::mutex> lock(slot.writeMutex);
+            queueFrame(slot, kOpClose, payload, sizeof(payload));
+            return false;
+        }
+        const auto total = header + static_cast<std::size_t>(length);
+        if (available < total) {
+            if (!slot.inOverflow && total > kSlotBufferSize) {
+                slot.overflow.assign(reinterpret_cast<char*>(frame), available);
+                slot.overflow.resize(total);
+                slot.inOverflow = true;
+                slot.used = available;
+                return true;
+            }
+            break;
+        }
+
+        auto* payload = reinterpret_cast<char*>(frame + header);
+        const auto size = static_cast<std::size_t>(length);
+        unmask(payload, size, payload - 4);
+        offset += total;
+        switch (opcode) {
+        case kOpText:
+        case kOpBinary:
+            if (slot.fragmenting) return false;
+            if (!fin) {
+                slot.fragmenting = true;
+                slot.fragmentIsText = opcode == kOpText;
+                if (slot.fragmentIsText) slot.fragments.assign(payload, size);
+            } else if (opcode == kOpText) {
+                m_callbacks.onMessage(slot.token, std::string(payload, size), slot.receivedNs);
+            }
+            break;
+        case kOpContinuation:
+            if (!slot.fragmenting) return false;
+            if (slot.fragmentIsText) {
+                if (slot.fragments.size() + size > slot.maxMessageSize) return false;
+                slot.fragments.append(payload, size);
+            }
+            if (fin) {
+                slot.fragmenting = false;
+                if (slot.fragmentIsText) m_callbacks.onMessage(slot.token, slot.fragments, slot.receivedNs);
+                std::string().swap(slot.fragments);
+            }
+            break;
+        case kOpPing: {
+            std::lock_guard<std::mutex> lock(slot.writeMutex);
+            queueFrame(slot, kOpPong, payload, size);
+            break;
+        }
+        case kOpPong:
+            break;
+        case kOpClose: {
+            std::lock_guard<std::mutex> lock(slot.writeMutex);
+            if (slot.state == SlotState::Open) {
+                queueFrame(slot, kOpClose, payload, std::min<std::size_t>(size, 2));
+                slot.state = SlotState::Closing;
+                slot.stateSince = Clock::now();
+                slot.shutdownAfterFlush = true;
+                flushSlotLocked(slot);
+            }
+            break;
+        }
+        default:
+            return false;
+        }
+    }
+
+    if (slot.inOverflow) {
+        if (offset == 0) return true;
+        slot.inOverflow = false;
+        slot.used = 0;
+        std::string().swap(slot.overflow);
+    } else if (offset > 0) {
+        std::memmove(slot.buffer, slot.buffer + offset, slot.used - offset);
+        slot.used -= offset;
+    }
+    return true;
+}
+
+void NativeTransport::queueFrame(Slot& slot, std::uint8_t opcode, const char* payload, std::size_t size)
+{
+    char header[10];
+    const auto headerSize = encodeHeader(header, opcode, size);
+    if (slot.pendingOffset == slot.pending.size()) {
+        iovec parts[2] = {{header, headerSize}, {const_cast<char*>(payload), size}};
+        msghdr message{};
+        message.msg_iov = parts;
+        message.msg_iovlen = size ? 2 : 1;
+        auto written = sendmsg(slot.fd, &message, MSG_NOSIGNAL | MSG_DONTWAIT);
+        if (written < 0) {
+            if (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR) return;
+            written = 0;
+        }
+        const auto sent = static_cast<std::size_t>(written);
+        if (sent == headerSize + size) {
+            if (slot.shutdownAfterFlush) shutdown(slot.fd, SHUT_WR);
+            return;
+        }
+        slot.pending.clear();
+        slot.pendingOffset = 0;
+        if (sent < headerSize) slot.pending.append(header + sent, headerSize - sent);
+        const auto payloadSent = sent > headerSize ? sent - headerSize : 0;
+        slot.pending.append(payload + payloadSent, size - payloadSent);
+    } else {
+        slot.pending.append(header, headerSize);
+        slot.pending.append(payload, size);
+    }
+    if (!slot.writeArmed) {
+        slot.writeArmed = true;
+        armWrite(slot.epollFd, slot.fd, slot.eventData(), true);
+    }
+}
+
+void NativeTransport::flushSlot(Slot& slot)
+{
+    std::lock_guard<std::mutex> lock(slot.writeMutex);
+    flushSlotLocked(slot);
+}
+
+void NativeTransport::flushSlotLocked(Slot& slot)
+{
+    while (slot.pendingOffset < slot.pending.size()) {
+        const auto written = ::send(slot.fd, slot.pending.data() + slot.pendingOffset, slot.pending.size() - slot.pendingOffset,
+            MSG_NOSIGNAL | MSG_DONTWAIT);
+        if (written < 0) {
+            if (errno == EINTR) continue;
+            if ((errno == EAGAIN || errno == EWOULDBLOCK) && !slot.writeArmed) {
+                slot.writeArmed = true;
+                armWrite(slot.epollFd, slot.fd, slot.eventData(), true);
+            }
+            return;
+        }
+        slot.pendingOffset += static_cast<std::size_t>(written);
+    }
+    slot.pending.clear();
+    slot.pendingOffset = 0;
+    if (slot.pending.capacity() > kSlotBufferSize) std::string().swap(slot.pending);
+    if (slot.writeArmed) {
+        slot.writeArmed = false;
+        armWrite(slot.epollFd, slot.fd, slot.eventData(), false);
+    }
+    if (slot.shutdownAfterFlush) shutdown(slot.fd, SHUT_WR);
+}
+
+void NativeTransport::closeSlot(Loop& loop, Slot& slot)
+{
+    std::shared_ptr<Slot::Token> token;
+    bool opened = false;
+    {
+        std::lock_guard<std::mutex> lock(slot.writeMutex);
+        if (slot.state == SlotState::Free) return;
+        opened = slot.state != SlotState::Handshake;
+        epoll_ctl(loop.epollFd, EPOLL_CTL_DEL, slot.fd, nullptr);
+        ::close(slot.fd);
+        slot.fd = -1;
+        slot.state = SlotState::Free;
+        ++slot.generation;
+        std::string().swap(slot.pending);
+        slot.pendingOffset = 0;
+        slot.writeArmed = false;
+        slot.shutdownAfterFlush = false;
+        token = std::move(slot.token);
+    }
+    slot.used = 0;
+    slot.inOverflow = false;
+    slot.fragmenting = false;
+    std::string().swap(slot.overflow);
+    std::string().swap(slot.fragments);
+    madvise(slot.buffer, kSlotBufferSize, MADV_DONTNEED);
+    loop.freeSlots.push_back(slot.index);
+    if (opened) m_callbacks.onClose(token);
+}
+
+void NativeTransport::sweepTimeouts(Loop& loop)
+{
+    const auto config = currentConfig();
+    const auto now = Clock::now();
+    for (std::size_t i = 0; i < loop.slotCount; ++i) {
+        auto& slot = loop.slots[i];
+        const auto state = slot.state.load();
+        if (state != SlotState::Handshake && state != SlotState::Closing) continue;
+        Clock::time_point since;
+        {
+            std::lock_guard<std::mutex> lock(slot.writeMutex);
+            since = slot.stateSince;
+        }
+        const auto timeoutMs = state == SlotState::Handshake ? config.openHandshakeTimeoutMs : config.closeHandshakeTimeoutMs;
+        if (now - since >= std::chrono::milliseconds(timeoutMs)) closeSlot(loop, slot);
+    }
+}
+
+NativeTransport::Slot* NativeTransport::lockSlot(const ConnectionHandle& handle, std::unique_lock<std::mutex>& lock)
+{
+    const auto token = std::static_pointer_cast<Slot::Token>(handle.lock());
+    if (!token) return nullptr;
+    auto& slot = *token->slot;
+    lock = std::unique_lock<std::mutex>(slot.writeMutex);
+    if (slot.generation != token->generation || slot.state == SlotState::Free) return nullptr;
+    return &slot;
+}
+
+void NativeTransport::send(const ConnectionHandle& handle, const std::string& message, std::error_code& error)
+{
+    std::unique_lock<std::mutex> lock;
+    auto* slot = lockSlot(handle, lock);
+    if (!slot || slot->state != SlotState::Open) {
+        error = std::make_error_code(std::errc::not_connected);
+        return;
+    }
+    error.clear();
+    queueFrame(*slot, kOpText, message.data(), message.size());
+}
+
+void NativeTransport::close(const ConnectionHandle& handle, websocketpp::close::status::value code, const std::string& reason, std::error_code& error)
+{
+    std::unique_lock<std::mutex> lock;
+    auto* slot = lockSlot(handle, lock);
+    if (!slot || slot->state != SlotState::Open) {
+        error = std::make_error_code(std::errc::not_connected);
+        return;
+    }
+    error.clear();
+    std::string payload;
+    payload.push_back(static_cast<char>(code >> 8));
+    payload.push_back(static_cast<char>(code & 0xFF));
+    payload.append(reason.substr(0, 123));
+    slot->state = SlotState::Closing;
+    slot->stateSince = Clock::now();
+    slot->shutdownAfterFlush = true;
+    queueFrame(*slot, kOpClose, payload.data(), payload.size());
+}
+
+std::size_t NativeTransport::bufferedAmount(const ConnectionHandle& handle)
+{
+    std::unique_lock<std::mutex> lock;
+    const auto* slot = lockSlot(handle, lock);
+    return slot ? slot->pending.size() - slot->pendingOffset : 0;
+}
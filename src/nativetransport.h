@@ -0,0 +1,66 @@
+#pragma once
+
+#include "clienttransport.h"
+#include "config_util.h"
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Minimal epoll WebSocket server for the subset the signaling protocol uses:
+// query-string handshake, text frames, ping/pong and close. Connections live in
+// fixed slots; read buffers are one lazily committed mapping, frames are
+// unmasked in place and outgoing frames go to the socket with writev.
+class NativeTransport : public ClientTransport {
+public:
+    struct Callbacks {
+        std::function<void(ConnectionHandle, const std::string& resource, const std::string& remoteAddress)> onOpen;
+        std::function<void(ConnectionHandle)> onClose;
+        // receivedNs is the steady_clock time at which the frame's last bytes were read.
+        std::function<void(ConnectionHandle, const std::string& payload, std::int64_t receivedNs)> onMessage;
+    };
+
+    NativeTransport(const TransportConfig& config, Callbacks callbacks);
+    ~NativeTransport() override;
+
+    bool listen(std::uint16_t port);
+    void start();
+    void stop();
+    void join();
+    void setTransportConfig(const TransportConfig& config);
+
+    void send(const ConnectionHandle& handle, const std::string& message, std::error_code& error) override;
+    void close(const ConnectionHandle& handle, websocketpp::close::status::value code, const std::string& reason, std::error_code& error) override;
+    std::size_t bufferedAmount(const ConnectionHandle& handle) override;
+
+private:
+    struct Slot;
+    struct Loop;
+
+    void runLoop(Loop& loop);
+    void acceptConnections(Loop& loop);
+    void readSlot(Loop& loop, Slot& slot);
+    bool processHandshake(Slot& slot);
+    bool processFrames(Slot& slot);
+    void flushSlot(Slot& slot);
+    void flushSlotLocked(Slot& slot);
+    void closeSlot(Loop& loop, Slot& slot);
+    void sweepTimeouts(Loop& loop);
+    Slot* lockSlot(const ConnectionHandle& handle, std::unique_lock<std::mutex>& lock);
+    void queueFrame(Slot& slot, std::uint8_t opcode, const char* payload, std::size_t size);
+    TransportConfig currentConfig() const;
+
+    mutable std::mutex m_configMutex;
+    TransportConfig m_config;
+    Callbacks m_callbacks;
+    std::vector<std::unique_ptr<Loop>> m_loops;
+    std::vector<std::thread> m_threads;
+    char* m_buffers = nullptr;
+    std::size_t m_buffersSize = 0;
+    std::atomic_bool m_running{false};
+};
@@ -0,0 +1,89 @@
+#include "offlinequeue.h"
+
+#include <algorithm>
+
+void OfflineQueue::configure(const StoreForwardConfig& config)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_config = config;
+    m_enabled = config.enabled && config.ttlMs > 0 && config.maxMessagesPerSession > 0;
+    if (m_enabled) return;
+    for (const auto& entry : m_entries) m_stats.dropped.fetch_add(entry.second.messages.size(), std::memory_order_relaxed);
+    m_entries.clear();
+    m_bytes = 0;
+}
+
+void OfflineQueue::markOffline(const std::string& receiver)
+{
+    if (!isEnabled()) return;
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_entries[receiver].deadline = Clock::now() + std::chrono::milliseconds(m_config.ttlMs);
+}
+
+OfflineQueue::EnqueueResult OfflineQueue::enqueue(const std::string& receiver, const std::string& sender, const std::string& payload)
+{
+    if (!isEnabled()) return EnqueueResult::NotHeld;
+    std::lock_guard<std::mutex> lock(m_mutex);
+    const auto it = m_entries.find(receiver);
+    if (it == m_entries.end() || it->second.deadline <= Clock::now()) return EnqueueResult::NotHeld;
+    const auto bytes = sender.size() + payload.size();
+    if (it->second.messages.size() >= m_config.maxMessagesPerSession || m_bytes + bytes > m_config.maxBytes) {
+        m_stats.dropped.fetch_add(1, std::memory_order_relaxed);
+        return EnqueueResult::Full;
+    }
+    it->second.messages.push_back({sender, payload});
+    m_bytes += bytes;
+    m_stats.queued.fetch_add(1, std::memory_order_relaxed);
+    return EnqueueResult::Queued;
+}
+
+bool OfflineQueue::drain(const std::string& receiver, std::vector<Message>& batch, const std::function<void()>& onEmpty)
+{
+    batch.clear();
+    std::lock_guard<std::mutex> lock(m_mutex);
+    const auto it = m_entries.find(receiver);
+    if (it == m_entries.end() || it->second.messages.empty()) {
+        if (it != m_entries.end()) m_entries.erase(it);
+        onEmpty();
+        return false;
+    }
+    for (auto& message : it->second.messages) {
+        m_bytes -= messageBytes(message);
+        batch.push_back(std::move(message));
+    }
+    it->second.messages.clear();
+    m_stats.delivered.fetch_add(batch.size(), std::memory_order_relaxed);
+    return true;
+}
+
+std::vector<std::string> OfflineQueue::purgeExpired(Clock::time_point now)
+{
+    std::vector<std::string> senders;
+    std::lock_guard<std::mutex> lock(m_mutex);
+    for (auto it = m_entries.begin(); it != m_entries.end();) {
+        if (it->second.deadline > now) {
+            ++it;
+            continue;
+        }
+        for (const auto& message : it->second.messages) {
+            m_bytes -= messageBytes(message);
+            if (std::find(senders.begin(), senders.end(), message.sender) == senders.end()) senders.push_back(message.sender);
+        }
+        m_stats.expired.fetch_add(it->second.messages.size(), std::memory_order_relaxed);
+        it = m_entries.erase(it);
+    }
+    return senders;
+}
+
+void OfflineQueue::clear()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_entries.clear();
+    m_bytes = 0;
+}
+
+std::size_t OfflineQueue::getQueuedBytes() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_bytes;
+}
@@ -0,0 +1,66 @@
+#pragma once
+
+#include "config_util.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+struct OfflineQueueStats {
+    std::atomic<std::uint64_t> queued{0};
+    std::atomic<std::uint64_t> delivered{0};
+    std::atomic<std::uint64_t> expired{0};
+    std::atomic<std::uint64_t> dropped{0};
+};
+
+// Holds signaling messages for receivers that disconnected less than ttlMs ago
+// so a quick reconnect can pick them up in order instead of the sender
+// restarting negotiation.
+class OfflineQueue {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    struct Message {
+        std::string sender;
+        std::string payload;
+    };
+
+    enum class EnqueueResult { Queued, NotHeld, Full };
+
+    void configure(const StoreForwardConfig& config);
+    bool isEnabled() const { return m_enabled.load(std::memory_order_relaxed); }
+    void markOffline(const std::string& receiver);
+    EnqueueResult enqueue(const std::string& receiver, const std::string& sender, const std::string& payload);
+    // Moves queued messages for receiver into batch and returns true while any
+    // remain. Once the queue is empty the entry is removed and onEmpty runs under
+    // the queue lock, so no message can slip in between draining and attaching
+    // the new connection.
+    bool drain(const std::string& receiver, std::vector<Message>& batch, const std::function<void()>& onEmpty);
+    // Drops entries whose window has passed and returns the distinct senders of
+    // the messages that expired.
+    std::vector<std::string> purgeExpired(Clock::time_point now = Clock::now());
+    void clear();
+    std::size_t getQueuedBytes() const;
+    const OfflineQueueStats& getStats() const { return m_stats; }
+
+private:
+    struct Entry {
+        Clock::time_point deadline;
+        std::deque<Message> messages;
+    };
+
+    static std::size_t messageBytes(const Message& message) { return message.sender.size() + message.payload.size(); }
+
+    std::atomic_bool m_enabled{false};
+    mutable std::mutex m_mutex;
+    StoreForwardConfig m_config;
+    std::unordered_map<std::string, Entry> m_entries;
+    std::size_t m_bytes = 0;
+    OfflineQueueStats m_stats;
+};
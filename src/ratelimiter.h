@@ -0,0 +1,52 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+class TokenBucket {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    TokenBucket() = default;
+    TokenBucket(double ratePerSecond, double burst) { configure(ratePerSecond, burst); }
+
+    void configure(double ratePerSecond, double burst)
+    {
+        m_rate = ratePerSecond > 0 ? ratePerSecond / 1e9 : 0;
+        m_burst = std::max(burst, 1.0);
+        m_tokens = m_burst;
+        m_lastRefill = Clock::now();
+    }
+
+    bool isEnabled() const { return m_rate > 0; }
+
+    bool tryConsume() { return m_rate <= 0 || tryConsume(Clock::now()); }
+
+    bool tryConsume(Clock::time_point now)
+    {
+        if (m_rate <= 0) return true;
+        const auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(now - m_lastRefill).count();
+        if (elapsed > 0) {
+            m_tokens = std::min(m_burst, m_tokens + static_cast<double>(elapsed) * m_rate);
+            m_lastRefill = now;
+        }
+        if (m_tokens < 1.0) return false;
+        m_tokens -= 1.0;
+        return true;
+    }
+
+private:
+    double m_rate = 0;
+    double m_burst = 1;
+    double m_tokens = 1;
+    Clock::time_point m_lastRefill{};
+};
+
+struct RateLimitStats {
+    std::atomic<std::uint64_t> dropped{0};
+    std::atomic<std::uint64_t> receiverDropped{0};
+    std::atomic<std::uint64_t> errorReplies{0};
+    std::atomic<std::uint64_t> disconnects{0};
+};
@@ -0,0 +1,118 @@
+#include "tlscontext.h"
+#include "logger_manager.h"
+
+#include <fstream>
+#include <iterator>
+#include <openssl/crypto.h>
+#include <string>
+
+namespace {
+constexpr unsigned char kSessionIdContext[] = "signal_server";
+// Key name, HMAC secret and AES key as expected by SSL_CTX_set_tlsext_ticket_keys.
+constexpr std::size_t kTicketKeySize = 80;
+
+// asio keeps its verify callback in the SSL_CTX app data and deletes it with
+// the context, so the owning TlsContext is stored in its own ex_data slot.
+int contextIndex()
+{
+    static const int index = SSL_CTX_get_ex_new_index(0, nullptr, nullptr, nullptr, nullptr);
+    return index;
+}
+
+std::filesystem::path resolve(const std::filesystem::path& baseDir, const std::string& file)
+{
+    std::filesystem::path path(file);
+    return path.is_relative() ? baseDir / path : path;
+}
+
+std::filesystem::file_time_type modified(const std::filesystem::path& path)
+{
+    std::error_code error;
+    return std::filesystem::last_write_time(path, error);
+}
+
+bool sameSettings(const TlsConfig& a, const TlsConfig& b)
+{
+    return a.certificateFile == b.certificateFile && a.privateKeyFile == b.privateKeyFile && a.ciphers == b.ciphers
+        && a.sessionCacheSize == b.sessionCacheSize && a.sessionTimeoutSec == b.sessionTimeoutSec && a.sessionTickets == b.sessionTickets
+        && a.ticketKeyFile == b.ticketKeyFile;
+}
+}
+
+bool TlsContext::load(const TlsConfig& config, const std::filesystem::path& baseDir)
+{
+    const std::array<std::filesystem::file_time_type, 3> times{modified(resolve(baseDir, config.certificateFile)),
+        modified(resolve(baseDir, config.privateKeyFile)),
+        config.ticketKeyFile.empty() ? std::filesystem::file_time_type() : modified(resolve(baseDir, config.ticketKeyFile))};
+    const auto previous = get();
+    if (previous && sameSettings(config, m_loadedConfig) && times == m_loadedTimes) {
+        LOG_INFO("TLS settings and files unchanged, keeping the current SSL context");
+        return true;
+    }
+
+    auto context = std::make_shared<asio::ssl::context>(asio::ssl::context::tls_server);
+    try {
+        context->set_options(asio::ssl::context::default_workarounds | asio::ssl::context::no_sslv2 | asio::ssl::context::no_sslv3
+            | asio::ssl::context::no_tlsv1 | asio::ssl::context::no_tlsv1_1 | asio::ssl::context::single_dh_use);
+        context->use_certificate_chain_file(resolve(baseDir, config.certificateFile).string());
+        context->use_private_key_file(resolve(baseDir, config.privateKeyFile).string(), asio::ssl::context::pem);
+    } catch (const std::exception& error) {
+        LOG_ERROR("Unable to load TLS certificate {}: {}", config.certificateFile, error.what());
+        return false;
+    }
+
+    SSL_CTX* native = context->native_handle();
+    if (!config.ciphers.empty() && SSL_CTX_set_cipher_list(native, config.ciphers.c_str()) != 1) {
+        LOG_ERROR("Invalid TLS cipher list: {}", config.ciphers);
+        return false;
+    }
+    SSL_CTX_set_session_id_context(native, kSessionIdContext, sizeof(kSessionIdContext) - 1);
+    SSL_CTX_set_session_cache_mode(native, config.sessionCacheSize > 0 ? SSL_SESS_CACHE_SERVER : SSL_SESS_CACHE_OFF);
+    SSL_CTX_sess_set_cache_size(native, static_cast<long>(config.sessionCacheSize));
+    SSL_CTX_set_timeout(native, config.sessionTimeoutSec);
+    // Without tickets TLS 1.3 resumption falls back to stateful tickets that
+    // point into the session cache.
+    if (!config.sessionTickets) SSL_CTX_set_options(native, SSL_OP_NO_TICKET);
+    if (config.sessionTickets && !config.ticketKeyFile.empty()) {
+        std::ifstream input(resolve(baseDir, config.ticketKeyFile), std::ios::binary);
+        std::string keys((std::istreambuf_iterator<char>(input)), std::istreambuf_iterator<char>());
+        if (keys.size() != kTicketKeySize) {
+            LOG_ERROR("TLS ticket key file {} must hold exactly {} bytes", config.ticketKeyFile, kTicketKeySize);
+            return false;
+        }
+        SSL_CTX_set_tlsext_ticket_keys(native, keys.data(), static_cast<long>(keys.size()));
+    } else if (config.sessionTickets && previous) {
+        // Keep the process-local keys so tickets issued before the reload
+        // still resume.
+        unsigned char keys[kTicketKeySize];
+        if (SSL_CTX_get_tlsext_ticket_keys(previous->native_handle(), keys, sizeof(keys)) == 1) {
+            SSL_CTX_set_tlsext_ticket_keys(native, keys, sizeof(keys));
+        }
+        OPENSSL_cleanse(keys, sizeof(keys));
+    }
+
+    SSL_CTX_set_ex_data(native, contextIndex(), this);
+    SSL_CTX_set_info_callback(native, &TlsContext::onInfo);
+
+    std::atomic_store(&m_context, context);
+    m_loadedConfig = config;
+    m_loadedTimes = times;
+    LOG_INFO("TLS context loaded: certificate={}, sessionCache={}, tickets={}", config.certificateFile, config.sessionCacheSize,
+        config.sessionTickets ? (config.ticketKeyFile.empty() ? "local keys" : "shared keys") : "off");
+    return true;
+}
+
+void TlsContext::onInfo(const SSL* ssl, int where, int ret)
+{
+    auto* self = static_cast<TlsContext*>(SSL_CTX_get_ex_data(SSL_get_SSL_CTX(ssl), contextIndex()));
+    if (!self) return;
+    auto& stats = self->m_stats;
+    if (where & SSL_CB_HANDSHAKE_START) {
+        stats.started.fetch_add(1, std::memory_order_relaxed);
+    } else if (where & SSL_CB_HANDSHAKE_DONE) {
+        stats.completed.fetch_add(1, std::memory_order_relaxed);
+        if (SSL_session_reused(ssl)) stats.resumed.fetch_add(1, std::memory_order_relaxed);
+    } else if ((where & SSL_CB_WRITE_ALERT) && (ret >> 8) == SSL3_AL_FATAL && !SSL_is_init_finished(ssl)) {
+        stats.failed.fetch_add(1, std::memory_order_relaxed);
+    }
+}
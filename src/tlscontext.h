@@ -0,0 +1,41 @@
+#pragma once
+
+#include "config_util.h"
+
+#include <array>
+#include <asio/ssl.hpp>
+#include <atomic>
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+
+// Counted by OpenSSL's info callback, so they cover the TLS handshake only:
+// failed counts fatal alerts the server sent during a handshake, while peers
+// that disconnect mid-handshake show up only as started minus completed.
+struct TlsStats {
+    std::atomic<std::uint64_t> started{0};
+    std::atomic<std::uint64_t> completed{0};
+    std::atomic<std::uint64_t> resumed{0};
+    std::atomic<std::uint64_t> failed{0};
+};
+
+// Owns the SSL context shared by every wss:// connection. Sessions are cached
+// and tickets issued on this one context, so a reconnecting client can resume
+// instead of running a full handshake. load() builds a fresh context only when
+// the settings or the certificate, key or ticket key files changed, which lets
+// SIGHUP rotate certificates without dropping the session cache on every
+// reload; connections already open keep the old context.
+class TlsContext {
+public:
+    bool load(const TlsConfig& config, const std::filesystem::path& baseDir);
+    std::shared_ptr<asio::ssl::context> get() const { return std::atomic_load(&m_context); }
+    const TlsStats& getStats() const { return m_stats; }
+
+private:
+    static void onInfo(const SSL* ssl, int where, int ret);
+
+    std::shared_ptr<asio::ssl::context> m_context;
+    TlsConfig m_loadedConfig;
+    std::array<std::filesystem::file_time_type, 3> m_loadedTimes{};
+    TlsStats m_stats;
+};
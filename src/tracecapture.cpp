@@ -0,0 +1,111 @@
+#include "tracecapture.h"
+#include "logger_manager.h"
+
+#include <cerrno>
+#include <cstring>
+
+TraceCapture::~TraceCapture() { close(); }
+
+bool TraceCapture::open(const std::filesystem::path& path, bool includePayloads, const std::vector<std::string>& sessions)
+{
+    close();
+    std::error_code error;
+    if (path.has_parent_path()) std::filesystem::create_directories(path.parent_path(), error);
+    m_output.open(path, std::ios::binary | std::ios::trunc);
+    if (!m_output) {
+        LOG_ERROR("Unable to open capture file {}", path.string());
+        return false;
+    }
+    if (!m_output.write(kTraceMagic, sizeof(kTraceMagic))) {
+        LOG_ERROR("Unable to write capture file {}: {}", path.string(), std::strerror(errno));
+        m_output.close();
+        return false;
+    }
+    m_path = path;
+    {
+        // A late append() from the previous capture may still be waiting on
+        // the mutex, so the fields it reads are only changed under it.
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_includePayloads = includePayloads;
+        m_start = std::chrono::steady_clock::now();
+        m_stopping = false;
+        m_buffer.clear();
+        m_buffer.reserve(kFlushThreshold * 2);
+        for (const auto& session : sessions) appendTraceRecord(m_buffer, TraceRecordType::Connect, 0, session, nullptr, nullptr, false);
+    }
+    m_writer = std::thread([this] { writeLoop(); });
+    m_enabled = true;
+    LOG_INFO("Capturing traffic to {} (payloads {}, {} session(s) already connected)", path.string(), includePayloads ? "on" : "off", sessions.size());
+    return true;
+}
+
+void TraceCapture::close()
+{
+    if (!m_enabled.exchange(false)) return;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stopping = true;
+    }
+    m_condition.notify_one();
+    if (m_writer.joinable()) m_writer.join();
+    m_output.close();
+    LOG_INFO("Capture file {} closed", m_path.string());
+}
+
+void TraceCapture::recordConnect(const std::string& session)
+{
+    if (isEnabled()) append(TraceRecordType::Connect, session, nullptr, nullptr);
+}
+
+void TraceCapture::recordDisconnect(const std::string& session)
+{
+    if (isEnabled()) append(TraceRecordType::Disconnect, session, nullptr, nullptr);
+}
+
+void TraceCapture::recordMessage(const std::string& session, const std::string& receiver, const std::string& payload)
+{
+    if (isEnabled()) append(TraceRecordType::Message, session, &receiver, &payload);
+}
+
+void TraceCapture::append(TraceRecordType type, const std::string& session, const std::string* receiver, const std::string* payload)
+{
+    bool flush = false;
+    {
+        // The clock is read under the lock so it can never precede an m_start
+        // set by a concurrent open(), and records stay in timestamp order.
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (m_stopping) return;
+        const auto timestamp = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - m_start).count();
+        appendTraceRecord(m_buffer, type, static_cast<std::uint64_t>(timestamp), session, receiver, payload, m_includePayloads);
+        flush = m_buffer.size() >= kFlushThreshold;
+    }
+    if (flush) m_condition.notify_one();
+}
+
+void TraceCapture::writeLoop()
+{
+    std::string pending;
+    pending.reserve(kFlushThreshold * 2);
+    while (true) {
+        bool stopping = false;
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_condition.wait_for(lock, std::chrono::seconds(1), [this] { return m_stopping || m_buffer.size() >= kFlushThreshold; });
+            m_buffer.swap(pending);
+            stopping = m_stopping;
+        }
+        if (!pending.empty()) {
+            m_output.write(pending.data(), static_cast<std::streamsize>(pending.size()));
+            m_output.flush();
+            pending.clear();
+            if (!m_output) {
+                LOG_ERROR("Unable to write capture file {}: {}, capture stopped", m_path.string(), std::strerror(errno));
+                std::lock_guard<std::mutex> lock(m_mutex);
+                m_stopping = true;
+                m_buffer.clear();
+                return;
+            }
+        }
+        if (stopping) return;
+    }
+}
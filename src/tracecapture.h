@@ -0,0 +1,45 @@
+#pragma once
+
+#include "tracefile.h"
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+class TraceCapture {
+public:
+    ~TraceCapture();
+    // Sessions that are already connected get a Connect record at time 0, so
+    // a capture started on a running server can still be replayed.
+    bool open(const std::filesystem::path& path, bool includePayloads, const std::vector<std::string>& sessions = {});
+    void close();
+    bool isEnabled() const { return m_enabled.load(std::memory_order_acquire); }
+    const std::filesystem::path& getPath() const { return m_path; }
+    void recordConnect(const std::string& session);
+    void recordDisconnect(const std::string& session);
+    void recordMessage(const std::string& session, const std::string& receiver, const std::string& payload);
+
+private:
+    void append(TraceRecordType type, const std::string& session, const std::string* receiver, const std::string* payload);
+    void writeLoop();
+
+    static constexpr std::size_t kFlushThreshold = 256 * 1024;
+
+    std::atomic_bool m_enabled{false};
+    bool m_includePayloads = false;
+    std::filesystem::path m_path;
+    std::chrono::steady_clock::time_point m_start;
+    std::mutex m_mutex;
+    std::condition_variable m_condition;
+    std::string m_buffer;
+    bool m_stopping = false;
+    std::ofstream m_output;
+    std::thread m_writer;
+};
@@ -0,0 +1,108 @@
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <string>
+
+// Capture file layout: the 8-byte magic followed by records of
+//   u8 type, u64 timestampNs, u16 sessionLength, session,
+// and for messages additionally
+//   u16 receiverLength, receiver, u32 size, u8 hasPayload, [payload].
+// Integers are little endian; timestamps count from the start of the capture.
+enum class TraceRecordType : std::uint8_t { Connect = 1, Disconnect = 2, Message = 3 };
+
+struct TraceRecord {
+    TraceRecordType type = TraceRecordType::Message;
+    std::uint64_t timestampNs = 0;
+    std::string session;
+    std::string receiver;
+    std::uint32_t size = 0;
+    bool hasPayload = false;
+    std::string payload;
+};
+
+constexpr char kTraceMagic[8] = {'S', 'S', 'T', 'R', 'A', 'C', 'E', '1'};
+
+inline void appendTraceInteger(std::string& out, std::uint64_t value, int bytes)
+{
+    for (int i = 0; i < bytes; ++i) out.push_back(static_cast<char>(value >> (8 * i)));
+}
+
+inline void appendTraceString(std::string& out, const std::string& value)
+{
+    const auto length = value.size() > 0xFFFF ? 0xFFFF : value.size();
+    appendTraceInteger(out, length, 2);
+    out.append(value, 0, length);
+}
+
+inline void appendTraceRecord(std::string& out, TraceRecordType type, std::uint64_t timestampNs, const std::string& session,
+    const std::string* receiver = nullptr, const std::string* payload = nullptr, bool includePayload = false)
+{
+    out.push_back(static_cast<char>(type));
+    appendTraceInteger(out, timestampNs, 8);
+    appendTraceString(out, session);
+    if (type != TraceRecordType::Message) return;
+    appendTraceString(out, receiver ? *receiver : std::string());
+    const auto size = payload ? payload->size() : 0;
+    appendTraceInteger(out, size, 4);
+    out.push_back(static_cast<char>(includePayload && payload ? 1 : 0));
+    if (includePayload && payload) out.append(*payload);
+}
+
+class TraceReader {
+public:
+    explicit TraceReader(const std::string& path) : m_input(path, std::ios::binary)
+    {
+        char magic[sizeof(kTraceMagic)] = {};
+        m_valid = m_input.read(magic, sizeof(magic)) && std::memcmp(magic, kTraceMagic, sizeof(magic)) == 0;
+    }
+
+    bool isValid() const { return m_valid; }
+
+    bool next(TraceRecord& record)
+    {
+        if (!m_valid) return false;
+        const auto type = m_input.get();
+        if (type == std::char_traits<char>::eof()) return false;
+        record.type = static_cast<TraceRecordType>(type);
+        record.receiver.clear();
+        record.payload.clear();
+        record.size = 0;
+        record.hasPayload = false;
+        if (!readInteger(record.timestampNs, 8) || !readString(record.session)) return false;
+        if (record.type != TraceRecordType::Message) return true;
+        std::uint64_t size = 0;
+        if (!readString(record.receiver) || !readInteger(size, 4)) return false;
+        record.size = static_cast<std::uint32_t>(size);
+        const auto hasPayload = m_input.get();
+        if (hasPayload == std::char_traits<char>::eof()) return false;
+        record.hasPayload = hasPayload != 0;
+        if (record.hasPayload) {
+            record.payload.resize(record.size);
+            if (!m_input.read(&record.payload[0], record.size)) return false;
+        }
+        return true;
+    }
+
+private:
+    bool readInteger(std::uint64_t& value, int bytes)
+    {
+        unsigned char buffer[8] = {};
+        if (!m_input.read(reinterpret_cast<char*>(buffer), bytes)) return false;
+        value = 0;
+        for (int i = bytes - 1; i >= 0; --i) value = (value << 8) | buffer[i];
+        return true;
+    }
+
+    bool readString(std::string& value)
+    {
+        std::uint64_t length = 0;
+        if (!readInteger(length, 2)) return false;
+        value.resize(static_cast<std::size_t>(length));
+        return length == 0 || static_cast<bool>(m_input.read(&value[0], static_cast<std::streamsize>(length)));
+    }
+
+    std::ifstream m_input;
+    bool m_valid = false;
+};
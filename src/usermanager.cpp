@@ -77,8 +77,26 @@ bool UserManager::isUserOnline(const std::string& sn) const
     return it != m_users.end() && it->second.getStatus() == 1;
 }
 
+std::vector<UserPresence> UserManager::queryPresence(const std::vector<std::string>& sns) const
+{
+    std::vector<UserPresence> result(sns.size());
+    std::lock_guard<std::mutex> lock(m_mutex);
+    for (std::size_t i = 0; i < sns.size(); ++i) {
+        result[i].sn = sns[i];
+        const auto it = m_users.find(sns[i]);
+        if (it == m_users.end()) continue;
+        result[i].known = true;
+        result[i].online = it->second.getStatus() == 1;
+        result[i].loginDate = it->second.getLoginDate();
+    }
+    return result;
+}
+
 void UserManager::saveUsersToFile()
 {
+    // Connects and disconnects on different event loop threads save
+    // concurrently; they share the temporary file, so writes are serialized.
+    std::lock_guard<std::mutex> saveLock(m_saveMutex);
     nlohmann::json users = nlohmann::json::array();
     {
         std::lock_guard<std::mutex> lock(m_mutex);
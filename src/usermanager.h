@@ -5,6 +5,14 @@
 #include <mutex>
 #include <string>
 #include <unordered_map>
+#include <vector>
+
+struct UserPresence {
+    std::string sn;
+    bool known = false;
+    bool online = false;
+    std::string loginDate;
+};
 
 class UserManager {
 public:
@@ -17,6 +25,7 @@ public:
     void setUserOnline(const std::string& sn);
     void setUserOffline(const std::string& sn);
     bool isUserOnline(const std::string& sn) const;
+    std::vector<UserPresence> queryPresence(const std::vector<std::string>& sns) const;
 
 private:
     UserManager() = default;
@@ -24,6 +33,7 @@ private:
     void loadUsersFromFile();
 
     mutable std::mutex m_mutex;
+    std::mutex m_saveMutex;
     std::unordered_map<std::string, RcsUser> m_users;
     std::filesystem::path m_filePath;
 };
@@ -1,7 +1,13 @@
 #pragma once
 
 #include <websocketpp/config/asio_no_tls.hpp>
+#ifdef SIGNAL_SERVER_TLS
+#include <websocketpp/config/asio.hpp>
+#endif
 #include <websocketpp/server.hpp>
 
 using WebSocketEndpoint = websocketpp::server<websocketpp::config::asio>;
+#ifdef SIGNAL_SERVER_TLS
+using TlsEndpoint = websocketpp::server<websocketpp::config::asio_tls>;
+#endif
 using ConnectionHandle = websocketpp::connection_hdl;
@@ -1,22 +1,79 @@
 #include "websocketclient.h"
 #include "logger_manager.h"
 
-WebSocketClient::WebSocketClient(WebSocketEndpoint& endpoint, ConnectionHandle handle, std::string remoteAddress)
-    : m_endpoint(endpoint), m_handle(std::move(handle)), m_remoteAddress(std::move(remoteAddress)) {}
+#include <chrono>
+
+namespace {
+std::int64_t currentTimeMs()
+{
+    return std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+}
+}
+
+WebSocketClient::WebSocketClient(ClientTransport& transport, ConnectionHandle handle, std::string remoteAddress)
+    : m_transport(transport), m_handle(std::move(handle)), m_remoteAddress(std::move(remoteAddress)),
+      m_connectedAtMs(currentTimeMs()), m_lastActivityMs(m_connectedAtMs.load()) {}
+
+void WebSocketClient::setRateLimits(const RateLimitConfig& config)
+{
+    m_inboundBucket.configure(config.messagesPerSecond, config.burst);
+    std::lock_guard<std::mutex> lock(m_receiveBucketMutex);
+    m_receiveBucket.configure(config.receiverMessagesPerSecond, config.receiverBurst);
+}
+
+bool WebSocketClient::allowInbound()
+{
+    if (!m_inboundBucket.tryConsume()) return false;
+    if (m_rateLimited.load(std::memory_order_relaxed)) m_rateLimited.store(false, std::memory_order_relaxed);
+    return true;
+}
+
+bool WebSocketClient::allowReceive()
+{
+    if (!m_receiveBucket.isEnabled()) return true;
+    std::lock_guard<std::mutex> lock(m_receiveBucketMutex);
+    return m_receiveBucket.tryConsume();
+}
+
+void WebSocketClient::recordInbound(std::size_t bytes)
+{
+    m_messagesIn.fetch_add(1, std::memory_order_relaxed);
+    m_bytesIn.fetch_add(bytes, std::memory_order_relaxed);
+    m_lastActivityMs.store(currentTimeMs(), std::memory_order_relaxed);
+}
+
+ClientTrafficStats WebSocketClient::getTrafficStats() const
+{
+    ClientTrafficStats stats;
+    stats.messagesIn = m_messagesIn.load(std::memory_order_relaxed);
+    stats.bytesIn = m_bytesIn.load(std::memory_order_relaxed);
+    stats.messagesOut = m_messagesOut.load(std::memory_order_relaxed);
+    stats.bytesOut = m_bytesOut.load(std::memory_order_relaxed);
+    stats.connectedAtMs = m_connectedAtMs.load(std::memory_order_relaxed);
+    stats.lastActivityMs = m_lastActivityMs.load(std::memory_order_relaxed);
+    return stats;
+}
+
+std::size_t WebSocketClient::getSendQueueDepth() const { return m_transport.bufferedAmount(m_handle); }
 
 void WebSocketClient::sendMessage(const std::string& message)
 {
     if (!isConnected()) return;
     websocketpp::lib::error_code error;
-    m_endpoint.send(m_handle, message, websocketpp::frame::opcode::text, error);
-    if (error) LOG_WARN("Unable to send to {}: {}", m_sessionId, error.message());
+    m_transport.send(m_handle, message, error);
+    if (error) {
+        LOG_WARN("Unable to send to {}: {}", m_sessionId, error.message());
+        return;
+    }
+    m_messagesOut.fetch_add(1, std::memory_order_relaxed);
+    m_bytesOut.fetch_add(message.size(), std::memory_order_relaxed);
 }
 
 void WebSocketClient::sendJsonMessage(const nlohmann::json& json) { sendMessage(json.dump()); }
 
-void WebSocketClient::close()
+void WebSocketClient::close(websocketpp::close::status::value code, const std::string& reason)
 {
     if (!m_connected.exchange(false)) return;
     websocketpp::lib::error_code error;
-    m_endpoint.close(m_handle, websocketpp::close::status::normal, "", error);
+    m_transport.close(m_handle, code, reason, error);
 }
@@ -1,13 +1,27 @@
 #pragma once
 
+#include "clienttransport.h"
+#include "config_util.h"
+#include "ratelimiter.h"
 #include "rcsuser.h"
 #include "websocket_types.h"
 #include <atomic>
+#include <cstdint>
+#include <mutex>
 #include <string>
 
+struct ClientTrafficStats {
+    std::uint64_t messagesIn = 0;
+    std::uint64_t bytesIn = 0;
+    std::uint64_t messagesOut = 0;
+    std::uint64_t bytesOut = 0;
+    std::int64_t connectedAtMs = 0;
+    std::int64_t lastActivityMs = 0;
+};
+
 class WebSocketClient {
 public:
-    WebSocketClient(WebSocketEndpoint& endpoint, ConnectionHandle handle, std::string remoteAddress);
+    WebSocketClient(ClientTransport& transport, ConnectionHandle handle, std::string remoteAddress);
 
     const std::string& getSessionId() const { return m_sessionId; }
     const std::string& getHostname() const { return m_hostname; }
@@ -16,18 +30,27 @@ public:
     ConnectionHandle getHandle() const { return m_handle; }
     const RcsUser& getRcsUser() const { return m_rcsUser; }
     bool isConnected() const { return m_connected.load(); }
+    bool acceptsCandidateBatches() const { return m_acceptsCandidateBatches; }
 
     void setSessionId(std::string value) { m_sessionId = std::move(value); }
     void setHostname(std::string value) { m_hostname = std::move(value); }
     void setInstallId(std::string value) { m_installId = std::move(value); }
     void setRcsUser(const RcsUser& value) { m_rcsUser = value; }
+    void setAcceptsCandidateBatches(bool value) { m_acceptsCandidateBatches = value; }
     void setDisconnected() { m_connected = false; }
+    void setRateLimits(const RateLimitConfig& config);
+    bool allowInbound();
+    bool allowReceive();
+    bool markRateLimited() { return !m_rateLimited.exchange(true); }
+    void recordInbound(std::size_t bytes);
+    ClientTrafficStats getTrafficStats() const;
+    std::size_t getSendQueueDepth() const;
     void sendMessage(const std::string& message);
     void sendJsonMessage(const nlohmann::json& json);
-    void close();
+    void close(websocketpp::close::status::value code = websocketpp::close::status::normal, const std::string& reason = {});
 
 private:
-    WebSocketEndpoint& m_endpoint;
+    ClientTransport& m_transport;
     ConnectionHandle m_handle;
     std::string m_sessionId;
     std::string m_hostname;
@@ -35,4 +58,15 @@ private:
     std::string m_remoteAddress;
     RcsUser m_rcsUser;
     std::atomic_bool m_connected{true};
+    std::atomic_bool m_rateLimited{false};
+    bool m_acceptsCandidateBatches = false;
+    TokenBucket m_inboundBucket;
+    TokenBucket m_receiveBucket;
+    std::mutex m_receiveBucketMutex;
+    std::atomic<std::uint64_t> m_messagesIn{0};
+    std::atomic<std::uint64_t> m_bytesIn{0};
+    std::atomic<std::uint64_t> m_messagesOut{0};
+    std::atomic<std::uint64_t> m_bytesOut{0};
+    std::atomic<std::int64_t> m_connectedAtMs;
+    std::atomic<std::int64_t> m_lastActivityMs;
 };
@@ -7,34 +7,121 @@
 #include <random>
 #include <sstream>
 #include <csignal>
+#include <thread>
+
+namespace {
+template <typename Endpoint>
+void configureEndpoint(Endpoint& endpoint, const TransportConfig& transport)
+{
+    endpoint.set_reuse_addr(true);
+    if (transport.listenBacklog > 0) endpoint.set_listen_backlog(transport.listenBacklog);
+    endpoint.set_max_message_size(transport.maxMessageSize);
+    endpoint.set_open_handshake_timeout(transport.openHandshakeTimeoutMs);
+    endpoint.set_close_handshake_timeout(transport.closeHandshakeTimeoutMs);
+}
+}
 
 WebSocketServer::WebSocketServer(std::string name, std::uint16_t port)
-    : m_serverName(std::move(name)), m_port(port), m_userManager(UserManager::instance()), m_messageHandler(this)
+    : m_endpointTransport(m_endpoint),
+#ifdef SIGNAL_SERVER_TLS
+      m_tlsTransport(m_tlsEndpoint),
+#endif
+      m_serverName(std::move(name)), m_port(port), m_userManager(UserManager::instance()), m_messageHandler(this),
+      m_transport(ConfigUtil->transport), m_rateLimit(ConfigUtil->rateLimit), m_rateLimitPenalty(m_rateLimit.penalty),
+      m_adminServer(*this, ConfigUtil->admin)
 {
+    m_offlineQueue.configure(ConfigUtil->storeForward);
     m_endpoint.clear_access_channels(websocketpp::log::alevel::all);
     m_endpoint.clear_error_channels(websocketpp::log::elevel::all);
     m_endpoint.init_asio();
-    m_endpoint.set_reuse_addr(true);
+    m_candidateBatcher = std::make_unique<CandidateBatcher>(m_endpoint.get_io_service(),
+        [this](const std::string& sender, const std::string& receiver, const std::string& frame) {
+            const auto result = relayMessage(receiver, frame, sender);
+            if (result == RelayResult::Offline) sendMessageToClient(sender, WsMsg::createOfflineMsg(sender).toJsonString());
+            return result == RelayResult::Sent || result == RelayResult::Queued;
+        },
+        [this](const std::string& receiver) { return acceptsCandidateBatches(receiver); });
+    m_candidateBatcher->configure(ConfigUtil->candidateBatch);
+    configureEndpoint(m_endpoint, m_transport);
+    m_endpoint.set_socket_init_handler([this](ConnectionHandle handle, asio::ip::tcp::socket& socket) { initSocket(m_endpoint, handle, socket); });
     m_endpoint.set_open_handler([this](ConnectionHandle handle) { onOpen(handle); });
     m_endpoint.set_close_handler([this](ConnectionHandle handle) { onClose(handle); });
     m_endpoint.set_fail_handler([this](ConnectionHandle handle) { onClose(handle); });
     m_endpoint.set_message_handler([this](ConnectionHandle handle, WebSocketEndpoint::message_ptr message) {
         onMessage(handle, std::move(message));
     });
+#ifdef SIGNAL_SERVER_TLS
+    initTlsEndpoint();
+#endif
+}
+
+#ifdef SIGNAL_SERVER_TLS
+void WebSocketServer::initTlsEndpoint()
+{
+    m_tlsEndpoint.clear_access_channels(websocketpp::log::alevel::all);
+    m_tlsEndpoint.clear_error_channels(websocketpp::log::elevel::all);
+    m_tlsEndpoint.init_asio(&m_endpoint.get_io_service());
+    configureEndpoint(m_tlsEndpoint, m_transport);
+    m_tlsEndpoint.set_tls_init_handler([this](ConnectionHandle) { return m_tlsContext.get(); });
+    m_tlsEndpoint.set_socket_init_handler([this](ConnectionHandle handle, asio::ssl::stream<asio::ip::tcp::socket>& stream) {
+        initSocket(m_tlsEndpoint, handle, stream.next_layer());
+    });
+    m_tlsEndpoint.set_open_handler([this](ConnectionHandle handle) { onTlsOpen(handle); });
+    m_tlsEndpoint.set_close_handler([this](ConnectionHandle handle) { onClose(handle); });
+    m_tlsEndpoint.set_fail_handler([this](ConnectionHandle handle) { onClose(handle); });
+    m_tlsEndpoint.set_message_handler([this](ConnectionHandle handle, TlsEndpoint::message_ptr message) {
+        if (message->get_opcode() == websocketpp::frame::opcode::text) dispatchMessage(handle, message->get_payload());
+    });
 }
+#endif
 
 WebSocketServer::~WebSocketServer() { stop(); }
 
 bool WebSocketServer::start()
 {
     try {
-        m_endpoint.listen(m_port);
-        m_endpoint.start_accept();
+        if (useNativeTransport()) {
+#ifdef SIGNAL_SERVER_NATIVE_TRANSPORT
+            NativeTransport::Callbacks callbacks;
+            callbacks.onOpen = [this](ConnectionHandle handle, const std::string& resource, const std::string& remoteAddress) {
+                acceptClient(*m_nativeTransport, handle, resource, remoteAddress);
+            };
+            callbacks.onClose = [this](ConnectionHandle handle) { onClose(handle); };
+            callbacks.onMessage = [this](ConnectionHandle handle, const std::string& payload, std::int64_t receivedNs) {
+                dispatchMessage(handle, payload, receivedNs);
+            };
+            m_nativeTransport = std::make_unique<NativeTransport>(m_transport, std::move(callbacks));
+            if (!m_nativeTransport->listen(m_port)) return false;
+#endif
+        } else {
+            m_endpoint.listen(m_port);
+            m_endpoint.start_accept();
+        }
+#ifdef SIGNAL_SERVER_TLS
+        m_tls = ConfigUtil->tls;
+        if (m_tls.enabled) {
+            if (!m_tlsContext.load(m_tls, ConfigUtil->filePath.parent_path())) return false;
+            m_tlsEndpoint.listen(m_tls.port);
+            m_tlsEndpoint.start_accept();
+            LOG_INFO("WebSocket TLS listener on port {}", m_tls.port);
+        }
+#else
+        if (ConfigUtil->tls.enabled) LOG_WARN("[tls] is enabled but this build has no TLS support, wss:// is not available");
+#endif
         m_listening = true;
         m_cleanupTimer = std::make_unique<asio::steady_timer>(m_endpoint.get_io_service());
+        m_offlinePurgeTimer = std::make_unique<asio::steady_timer>(m_endpoint.get_io_service());
         m_signals = std::make_unique<asio::signal_set>(m_endpoint.get_io_service(), SIGINT, SIGTERM);
         m_signals->async_wait([this](const std::error_code&, int) { stop(); });
+#ifdef SIGHUP
+        m_reloadSignals = std::make_unique<asio::signal_set>(m_endpoint.get_io_service(), SIGHUP);
+        waitForReload();
+#endif
         scheduleCleanup();
+        scheduleOfflinePurge();
+        m_adminServer.start(m_endpoint.get_io_service());
+        applyCaptureConfig(ConfigUtil->capture);
+        applyCallTraceConfig(ConfigUtil->callTrace);
         LOG_INFO("WebSocket server listening on port {}", m_port);
         return true;
     } catch (const std::exception& error) {
@@ -43,24 +130,66 @@ bool WebSocketServer::start()
     }
 }
 
-void WebSocketServer::run() { m_endpoint.run(); }
+void WebSocketServer::run()
+{
+    unsigned threadCount = m_transport.workerThreads;
+    if (threadCount == 0) threadCount = std::max(1u, std::thread::hardware_concurrency());
+#ifdef SIGNAL_SERVER_NATIVE_TRANSPORT
+    if (m_nativeTransport) {
+        m_nativeTransport->start();
+        m_endpoint.run();
+        m_nativeTransport->join();
+        return;
+    }
+#endif
+    LOG_INFO("Running {} worker thread(s)", threadCount);
+    std::vector<std::thread> workers;
+    for (unsigned i = 1; i < threadCount; ++i) workers.emplace_back([this] { m_endpoint.run(); });
+    m_endpoint.run();
+    for (auto& worker : workers) worker.join();
+}
+
+bool WebSocketServer::useNativeTransport() const
+{
+    if (m_transport.engine != "native") return false;
+#ifdef SIGNAL_SERVER_NATIVE_TRANSPORT
+    return true;
+#else
+    LOG_WARN("Native transport is not available on this platform, using websocketpp");
+    return false;
+#endif
+}
 
 void WebSocketServer::stop()
 {
     if (!m_listening.exchange(false)) return;
     websocketpp::lib::error_code error;
     m_endpoint.stop_listening(error);
+#ifdef SIGNAL_SERVER_TLS
+    if (m_tls.enabled) m_tlsEndpoint.stop_listening(error);
+#endif
+    m_adminServer.stop();
     if (m_cleanupTimer) m_cleanupTimer->cancel();
+    if (m_offlinePurgeTimer) m_offlinePurgeTimer->cancel();
+    if (m_reloadSignals) m_reloadSignals->cancel();
+    m_traceCapture.close();
+    m_candidateBatcher->flushAll();
+    m_callTracer.flush(true);
+    m_offlineQueue.clear();
     std::vector<std::shared_ptr<WebSocketClient>> clients;
     {
         std::lock_guard<std::mutex> lock(m_clientsMutex);
         for (const auto& entry : m_clients) clients.push_back(entry.second);
         m_clients.clear();
+        m_clientsByHandle.clear();
     }
     for (const auto& client : clients) {
         m_userManager.setUserOffline(client->getSessionId());
         client->close();
     }
+#ifdef SIGNAL_SERVER_NATIVE_TRANSPORT
+    if (m_nativeTransport) m_nativeTransport->stop();
+#endif
 }
 
 std::size_t WebSocketServer::getOnlineCount() const
@@ -69,27 +198,90 @@ std::size_t WebSocketServer::getOnlineCount() const
     return m_clients.size();
 }
 
+std::vector<std::shared_ptr<WebSocketClient>> WebSocketServer::getClients() const
+{
+    std::vector<std::shared_ptr<WebSocketClient>> clients;
+    std::lock_guard<std::mutex> lock(m_clientsMutex);
+    clients.reserve(m_clients.size());
+    for (const auto& entry : m_clients) clients.push_back(entry.second);
+    return clients;
+}
+
 bool WebSocketServer::sendMessageToClient(const std::string& sessionId, const std::string& message)
 {
-    std::shared_ptr<WebSocketClient> client;
-    {
-        std::lock_guard<std::mutex> lock(m_clientsMutex);
-        const auto it = m_clients.find(sessionId);
-        if (it != m_clients.end()) client = it->second;
-    }
+    const auto client = findBySessionId(sessionId);
     if (!client || !client->isConnected()) return false;
     client->sendMessage(message);
     return true;
 }
 
+WebSocketServer::RelayResult WebSocketServer::relayMessage(const std::string& sessionId, const std::string& message, const std::string& senderId)
+{
+    auto client = findBySessionId(sessionId);
+    if (!client || !client->isConnected()) {
+        if (!m_offlineQueue.isEnabled()) return RelayResult::Offline;
+        switch (m_offlineQueue.enqueue(sessionId, senderId, message)) {
+        case OfflineQueue::EnqueueResult::Queued:
+            return RelayResult::Queued;
+        case OfflineQueue::EnqueueResult::Full:
+            return RelayResult::Offline;
+        case OfflineQueue::EnqueueResult::NotHeld:
+            break;
+        }
+        // The receiver may have finished draining its queue since the lookup above.
+        client = findBySessionId(sessionId);
+        if (!client || !client->isConnected()) return RelayResult::Offline;
+    }
+    if (!client->allowReceive()) {
+        m_rateLimitStats.receiverDropped.fetch_add(1, std::memory_order_relaxed);
+        return RelayResult::RateLimited;
+    }
+    client->sendMessage(message);
+    return RelayResult::Sent;
+}
+
+void WebSocketServer::applyRateLimitPenalty(WebSocketClient& client)
+{
+    switch (m_rateLimitPenalty.load(std::memory_order_relaxed)) {
+    case RateLimitPenalty::Drop:
+        break;
+    case RateLimitPenalty::Error:
+        if (client.markRateLimited()) {
+            m_rateLimitStats.errorReplies.fetch_add(1, std::memory_order_relaxed);
+            client.sendMessage(WsMsg::createRateLimitedMsg(client.getSessionId()).toJsonString());
+        }
+        break;
+    case RateLimitPenalty::Disconnect:
+        if (client.isConnected()) {
+            m_rateLimitStats.disconnects.fetch_add(1, std::memory_order_relaxed);
+            LOG_WARN("Disconnecting {} for exceeding the message rate limit", client.getSessionId());
+            client.close(websocketpp::close::status::policy_violation, "rate limit exceeded");
+        }
+        break;
+    }
+}
+
 void WebSocketServer::onOpen(ConnectionHandle handle)
 {
-    auto connection = m_endpoint.get_con_from_hdl(handle);
-    const auto query = parseQuery(connection->get_resource());
+    const auto connection = m_endpoint.get_con_from_hdl(handle);
+    acceptClient(m_endpointTransport, handle, connection->get_resource(), connection->get_remote_endpoint());
+}
+
+#ifdef SIGNAL_SERVER_TLS
+void WebSocketServer::onTlsOpen(ConnectionHandle handle)
+{
+    const auto connection = m_tlsEndpoint.get_con_from_hdl(handle);
+    acceptClient(m_tlsTransport, handle, connection->get_resource(), connection->get_remote_endpoint());
+}
+#endif
+
+void WebSocketServer::acceptClient(ClientTransport& transport, ConnectionHandle handle, const std::string& resource, const std::string& remoteAddress)
+{
+    const auto query = parseQuery(resource);
     const auto sessionIt = query.find("sessionId");
     if (sessionIt == query.end() || sessionIt->second.empty()) {
         websocketpp::lib::error_code error;
-        m_endpoint.close(handle, websocketpp::close::status::policy_violation, "sessionId is required", error);
+        transport.close(handle, websocketpp::close::status::policy_violation, "sessionId is required", error);
         return;
     }
 
@@ -117,16 +309,18 @@ void WebSocketServer::onOpen(ConnectionHandle handle)
         const auto replacement = createSessionId();
         nlohmann::json response = {{"type", "deviceIdConflict"}, {"sender", "server"}, {"receiver", sessionId},
             {"data", {{"reason", "duplicate_uuid"}, {"oldSessionId", sessionId}, {"newSessionId", replacement}}}};
-        m_endpoint.send(handle, response.dump(), websocketpp::frame::opcode::text);
         websocketpp::lib::error_code error;
-        m_endpoint.close(handle, websocketpp::close::status::policy_violation, "duplicate uuid", error);
+        transport.send(handle, response.dump(), error);
+        transport.close(handle, websocketpp::close::status::policy_violation, "duplicate uuid", error);
         return;
     }
 
-    auto client = std::make_shared<WebSocketClient>(m_endpoint, handle, connection->get_remote_endpoint());
+    auto client = std::make_shared<WebSocketClient>(transport, handle, remoteAddress);
     client->setSessionId(sessionId);
     client->setHostname(hostname);
     client->setInstallId(installId);
+    const auto batchIt = query.find("batchCandidates");
+    client->setAcceptsCandidateBatches(batchIt != query.end() && (batchIt->second == "1" || batchIt->second == "true"));
     RcsUser user = knownUser ? existingUser : RcsUser(sessionId, hostname, client->getRemoteAddress());
     user.setStatus(1);
     user.setHostname(hostname);
@@ -134,11 +328,28 @@ void WebSocketServer::onOpen(ConnectionHandle handle)
     user.setLoginIp(client->getRemoteAddress());
     user.setLoginDate(RcsUser::currentDateTime());
     client->setRcsUser(user);
-    m_userManager.updateRcsUser(user);
     {
+        std::lock_guard<std::mutex> lock(m_settingsMutex);
+        client->setRateLimits(m_rateLimit);
+    }
+    m_userManager.updateRcsUser(user);
+    const auto attach = [this, &sessionId, &client] {
         std::lock_guard<std::mutex> lock(m_clientsMutex);
         m_clients[sessionId] = client;
+        m_clientsByHandle[client->getHandle()] = client;
+    };
+    if (m_offlineQueue.isEnabled()) {
+        std::vector<OfflineQueue::Message> held;
+        std::size_t delivered = 0;
+        while (m_offlineQueue.drain(sessionId, held, attach)) {
+            for (const auto& message : held) client->sendMessage(message.payload);
+            delivered += held.size();
+        }
+        if (delivered > 0) LOG_INFO("Delivered {} held message(s) to {}", delivered, sessionId);
+    } else {
+        attach();
     }
+    m_traceCapture.recordConnect(sessionId);
     if (oldClient) oldClient->close();
     LOG_INFO("Client connected: {} from {} ({}), online={}", sessionId, client->getRemoteAddress(), hostname, getOnlineCount());
 }
@@ -148,30 +359,62 @@ void WebSocketServer::onClose(ConnectionHandle handle)
     const auto client = findByHandle(handle);
     if (!client) return;
     client->setDisconnected();
+    bool current = false;
     {
         std::lock_guard<std::mutex> lock(m_clientsMutex);
         const auto it = m_clients.find(client->getSessionId());
-        if (it != m_clients.end() && it->second == client) m_clients.erase(it);
+        current = it != m_clients.end() && it->second == client;
+        if (current) m_clients.erase(it);
+        m_clientsByHandle.erase(handle);
+    }
+    if (!current) {
+        LOG_INFO("Replaced connection closed: {}", client->getSessionId());
+        return;
     }
     m_userManager.setUserOffline(client->getSessionId());
+    m_offlineQueue.markOffline(client->getSessionId());
+    m_traceCapture.recordDisconnect(client->getSessionId());
     LOG_INFO("Client disconnected: {}, online={}", client->getSessionId(), getOnlineCount());
 }
 
 void WebSocketServer::onMessage(ConnectionHandle handle, WebSocketEndpoint::message_ptr message)
 {
+    if (message->get_opcode() == websocketpp::frame::opcode::text) dispatchMessage(handle, message->get_payload());
+}
+
+void WebSocketServer::dispatchMessage(ConnectionHandle handle, const std::string& payload, std::int64_t receivedNs)
+{
+    const auto dispatchNs = m_callTracer.isEnabled() ? CallTracer::nowNs() : 0;
+    if (!dispatchNs || !receivedNs) receivedNs = dispatchNs;
     const auto client = findByHandle(handle);
-    if (client && message->get_opcode() == websocketpp::frame::opcode::text) m_messageHandler.handleMessage(client.get(), message->get_payload());
+    if (!client) return;
+    client->recordInbound(payload.size());
+    if (!client->allowInbound()) {
+        m_rateLimitStats.dropped.fetch_add(1, std::memory_order_relaxed);
+        applyRateLimitPenalty(*client);
+        return;
+    }
+    m_messageHandler.handleMessage(client.get(), payload, receivedNs, dispatchNs);
 }
 
 std::shared_ptr<WebSocketClient> WebSocketServer::findByHandle(ConnectionHandle handle) const
 {
-    std::owner_less<ConnectionHandle> less;
     std::lock_guard<std::mutex> lock(m_clientsMutex);
-    for (const auto& entry : m_clients) {
-        const auto candidate = entry.second->getHandle();
-        if (!less(candidate, handle) && !less(handle, candidate)) return entry.second;
-    }
-    return {};
+    const auto it = m_clientsByHandle.find(handle);
+    return it == m_clientsByHandle.end() ? nullptr : it->second;
+}
+
+bool WebSocketServer::acceptsCandidateBatches(const std::string& sessionId) const
+{
+    const auto client = findBySessionId(sessionId);
+    return client && client->acceptsCandidateBatches();
+}
+
+std::shared_ptr<WebSocketClient> WebSocketServer::findBySessionId(const std::string& sessionId) const
+{
+    std::lock_guard<std::mutex> lock(m_clientsMutex);
+    const auto it = m_clients.find(sessionId);
+    return it == m_clients.end() ? nullptr : it->second;
 }
 
 void WebSocketServer::scheduleCleanup()
@@ -180,6 +423,10 @@ void WebSocketServer::scheduleCleanup()
     m_cleanupTimer->async_wait([this](const std::error_code& error) {
         if (!error && m_listening) {
             cleanupDisconnectedClients();
+            logRateLimitStats();
+            logOfflineQueueStats();
+            m_callTracer.expire();
+            m_callTracer.flush();
             scheduleCleanup();
         }
     });
@@ -191,6 +438,151 @@ void WebSocketServer::cleanupDisconnectedClients()
     for (auto it = m_clients.begin(); it != m_clients.end();) {
         if (!it->second->isConnected()) it = m_clients.erase(it); else ++it;
     }
+    for (auto it = m_clientsByHandle.begin(); it != m_clientsByHandle.end();) {
+        if (!it->second->isConnected()) it = m_clientsByHandle.erase(it); else ++it;
+    }
+}
+
+void WebSocketServer::logRateLimitStats()
+{
+    const auto dropped = m_rateLimitStats.dropped.load(std::memory_order_relaxed);
+    const auto receiverDropped = m_rateLimitStats.receiverDropped.load(std::memory_order_relaxed);
+    const auto total = dropped + receiverDropped;
+    if (total == m_loggedRateLimitEvents) return;
+    m_loggedRateLimitEvents = total;
+    LOG_WARN("Rate limit: dropped={}, receiverDropped={}, errorReplies={}, disconnects={}", dropped, receiverDropped,
+        m_rateLimitStats.errorReplies.load(std::memory_order_relaxed), m_rateLimitStats.disconnects.load(std::memory_order_relaxed));
+}
+
+void WebSocketServer::logOfflineQueueStats()
+{
+    const auto& stats = m_offlineQueue.getStats();
+    const auto queued = stats.queued.load(std::memory_order_relaxed);
+    const auto dropped = stats.dropped.load(std::memory_order_relaxed);
+    if (queued + dropped == m_loggedOfflineEvents) return;
+    m_loggedOfflineEvents = queued + dropped;
+    LOG_INFO("Store and forward: queued={}, delivered={}, expired={}, dropped={}, held={} bytes", queued,
+        stats.delivered.load(std::memory_order_relaxed), stats.expired.load(std::memory_order_relaxed), dropped, m_offlineQueue.getQueuedBytes());
+}
+
+void WebSocketServer::scheduleOfflinePurge()
+{
+    m_offlinePurgeTimer->expires_after(std::chrono::seconds(1));
+    m_offlinePurgeTimer->async_wait([this](const std::error_code& error) {
+        if (!error && m_listening) {
+            purgeOfflineMessages();
+            scheduleOfflinePurge();
+        }
+    });
+}
+
+void WebSocketServer::purgeOfflineMessages()
+{
+    for (const auto& sender : m_offlineQueue.purgeExpired()) sendMessageToClient(sender, WsMsg::createOfflineMsg(sender).toJsonString());
+}
+
+template <typename Endpoint>
+void WebSocketServer::initSocket(Endpoint& endpoint, ConnectionHandle handle, asio::ip::tcp::socket& socket)
+{
+    TransportConfig transport;
+    {
+        std::lock_guard<std::mutex> lock(m_settingsMutex);
+        transport = m_transport;
+    }
+    const auto apply = [&socket](const char* name, const auto& option) {
+        asio::error_code error;
+        socket.set_option(option, error);
+        if (error) LOG_DEBUG("Unable to set {}: {}", name, error.message());
+    };
+    apply("TCP_NODELAY", asio::ip::tcp::no_delay(transport.tcpNoDelay));
+    if (transport.sendBufferSize > 0) apply("SO_SNDBUF", asio::socket_base::send_buffer_size(transport.sendBufferSize));
+    if (transport.receiveBufferSize > 0) apply("SO_RCVBUF", asio::socket_base::receive_buffer_size(transport.receiveBufferSize));
+
+    websocketpp::lib::error_code connectionError;
+    const auto connection = endpoint.get_con_from_hdl(handle, connectionError);
+    if (connectionError || !connection) return;
+    connection->set_max_message_size(transport.maxMessageSize);
+    connection->set_open_handshake_timeout(transport.openHandshakeTimeoutMs);
+    connection->set_close_handshake_timeout(transport.closeHandshakeTimeoutMs);
+}
+
+void WebSocketServer::waitForReload()
+{
+    m_reloadSignals->async_wait([this](const std::error_code& error, int) {
+        if (error || !m_listening) return;
+        reloadConfig();
+        waitForReload();
+    });
+}
+
+void WebSocketServer::reloadConfig()
+{
+    ConfigUtil->load(ConfigUtil->filePath.parent_path());
+    LoggerManager::instance().getLogger()->set_level(ConfigUtil->logLevel);
+    const auto port = ConfigUtil->serverPort == 0 ? 8080 : ConfigUtil->serverPort;
+    if (port != m_port) LOG_WARN("serverPort changes require a restart");
+    const auto& admin = ConfigUtil->admin;
+    const auto& currentAdmin = m_adminServer.getConfig();
+    if (admin.address != currentAdmin.address || admin.port != currentAdmin.port || admin.token != currentAdmin.token) {
+        LOG_WARN("[admin] changes require a restart");
+    }
+    const auto& transport = ConfigUtil->transport;
+    {
+        std::lock_guard<std::mutex> lock(m_settingsMutex);
+        if (transport.listenBacklog != m_transport.listenBacklog || transport.workerThreads != m_transport.workerThreads
+            || transport.engine != m_transport.engine || transport.maxConnections != m_transport.maxConnections) {
+            LOG_WARN("engine, maxConnections, listenBacklog and workerThreads changes require a restart");
+        }
+        m_transport.tcpNoDelay = transport.tcpNoDelay;
+        m_transport.sendBufferSize = transport.sendBufferSize;
+        m_transport.receiveBufferSize = transport.receiveBufferSize;
+        m_transport.maxMessageSize = transport.maxMessageSize;
+        m_transport.openHandshakeTimeoutMs = transport.openHandshakeTimeoutMs;
+        m_transport.closeHandshakeTimeoutMs = transport.closeHandshakeTimeoutMs;
+        m_rateLimit = ConfigUtil->rateLimit;
+        m_rateLimitPenalty = m_rateLimit.penalty;
+        m_offlineQueue.configure(ConfigUtil->storeForward);
+        m_candidateBatcher->configure(ConfigUtil->candidateBatch);
+#ifdef SIGNAL_SERVER_NATIVE_TRANSPORT
+        if (m_nativeTransport) m_nativeTransport->setTransportConfig(m_transport);
+#endif
+    }
+    applyCaptureConfig(ConfigUtil->capture);
+    applyCallTraceConfig(ConfigUtil->callTrace);
+#ifdef SIGNAL_SERVER_TLS
+    const auto& tls = ConfigUtil->tls;
+    if (tls.enabled != m_tls.enabled || tls.port != m_tls.port) {
+        LOG_WARN("[tls] enabled and port changes require a restart");
+    } else if (m_tls.enabled) {
+        m_tls = tls;
+        m_tlsContext.load(m_tls, ConfigUtil->filePath.parent_path());
+    }
+#endif
+    LOG_INFO("Reloaded {}: tcpNoDelay={}, sendBufferSize={}, receiveBufferSize={}, maxMessageSize={}, rate={}/s",
+        ConfigUtil->filePath.string(), transport.tcpNoDelay, transport.sendBufferSize, transport.receiveBufferSize,
+        transport.maxMessageSize, ConfigUtil->rateLimit.messagesPerSecond);
+}
+
+void WebSocketServer::applyCaptureConfig(const CaptureConfig& config)
+{
+    const bool changed = config.enabled != m_captureConfig.enabled || config.file != m_captureConfig.file
+        || config.payloads != m_captureConfig.payloads;
+    if (!changed && config.enabled == m_traceCapture.isEnabled()) return;
+    m_captureConfig = config;
+    m_traceCapture.close();
+    if (!config.enabled) return;
+    std::filesystem::path path(config.file);
+    if (path.is_relative()) path = ConfigUtil->filePath.parent_path() / path;
+    std::vector<std::string> sessions;
+    for (const auto& client : getClients()) sessions.push_back(client->getSessionId());
+    m_traceCapture.open(path, config.payloads, sessions);
+}
+
+void WebSocketServer::applyCallTraceConfig(const CallTraceConfig& config)
+{
+    std::filesystem::path directory(config.directory);
+    if (directory.is_relative()) directory = ConfigUtil->filePath.parent_path() / directory;
+    m_callTracer.configure(config, directory);
 }
 
 std::unordered_map<std::string, std::string> WebSocketServer::parseQuery(const std::string& resource)
@@ -1,20 +1,38 @@
 #pragma once
 
+#include "adminserver.h"
+#include "calltracer.h"
+#include "candidatebatcher.h"
+#include "clienttransport.h"
+#include "config_util.h"
 #include "messagehandler.h"
+#include "offlinequeue.h"
+#include "ratelimiter.h"
+#ifdef SIGNAL_SERVER_TLS
+#include "tlscontext.h"
+#endif
+#include "tracecapture.h"
 #include "usermanager.h"
 #include "websocketclient.h"
 #include "websocket_types.h"
+#ifdef SIGNAL_SERVER_NATIVE_TRANSPORT
+#include "nativetransport.h"
+#endif
 
 #include <asio/steady_timer.hpp>
 #include <asio/signal_set.hpp>
 #include <cstdint>
+#include <map>
 #include <memory>
 #include <mutex>
 #include <string>
 #include <unordered_map>
+#include <vector>
 
 class WebSocketServer {
 public:
+    enum class RelayResult { Sent, Queued, Offline, RateLimited };
+
     WebSocketServer(std::string name, std::uint16_t port);
     ~WebSocketServer();
     bool start();
@@ -22,28 +40,89 @@ public:
     void stop();
     bool isListening() const { return m_listening; }
     std::size_t getOnlineCount() const;
+    std::vector<std::shared_ptr<WebSocketClient>> getClients() const;
     bool sendMessageToClient(const std::string& sessionId, const std::string& message);
+    RelayResult relayMessage(const std::string& sessionId, const std::string& message, const std::string& senderId);
+    void applyRateLimitPenalty(WebSocketClient& client);
+    const RateLimitStats& getRateLimitStats() const { return m_rateLimitStats; }
+    const OfflineQueue& getOfflineQueue() const { return m_offlineQueue; }
+    CandidateBatcher& getCandidateBatcher() { return *m_candidateBatcher; }
+    bool acceptsCandidateBatches(const std::string& sessionId) const;
+    TraceCapture& getTraceCapture() { return m_traceCapture; }
+    CallTracer& getCallTracer() { return m_callTracer; }
+    const CallTracer& getCallTracer() const { return m_callTracer; }
+    UserManager& getUserManager() { return m_userManager; }
+#ifdef SIGNAL_SERVER_TLS
+    const TlsContext& getTlsContext() const { return m_tlsContext; }
+#endif
     std::uint16_t getPort() const { return m_port; }
     const std::string& getServerName() const { return m_serverName; }
+    static std::unordered_map<std::string, std::string> parseQuery(const std::string& resource);
 
 private:
     void onOpen(ConnectionHandle handle);
+#ifdef SIGNAL_SERVER_TLS
+    void initTlsEndpoint();
+    void onTlsOpen(ConnectionHandle handle);
+#endif
     void onClose(ConnectionHandle handle);
     void onMessage(ConnectionHandle handle, WebSocketEndpoint::message_ptr message);
+    void acceptClient(ClientTransport& transport, ConnectionHandle handle, const std::string& resource, const std::string& remoteAddress);
+    // receivedNs is when the transport read the frame, or 0 if it does not know.
+    void dispatchMessage(ConnectionHandle handle, const std::string& payload, std::int64_t receivedNs = 0);
+    bool useNativeTransport() const;
     void scheduleCleanup();
     void cleanupDisconnectedClients();
+    void logRateLimitStats();
+    void logOfflineQueueStats();
+    void scheduleOfflinePurge();
+    void purgeOfflineMessages();
+    template <typename Endpoint>
+    void initSocket(Endpoint& endpoint, ConnectionHandle handle, asio::ip::tcp::socket& socket);
+    void waitForReload();
+    void reloadConfig();
+    void applyCaptureConfig(const CaptureConfig& config);
+    void applyCallTraceConfig(const CallTraceConfig& config);
     std::shared_ptr<WebSocketClient> findByHandle(ConnectionHandle handle) const;
-    static std::unordered_map<std::string, std::string> parseQuery(const std::string& resource);
+    std::shared_ptr<WebSocketClient> findBySessionId(const std::string& sessionId) const;
     static std::string createSessionId();
 
     WebSocketEndpoint m_endpoint;
+    WebsocketppTransport<WebSocketEndpoint> m_endpointTransport;
+#ifdef SIGNAL_SERVER_TLS
+    TlsEndpoint m_tlsEndpoint;
+    WebsocketppTransport<TlsEndpoint> m_tlsTransport;
+    TlsContext m_tlsContext;
+    TlsConfig m_tls;
+#endif
+#ifdef SIGNAL_SERVER_NATIVE_TRANSPORT
+    std::unique_ptr<NativeTransport> m_nativeTransport;
+#endif
     std::string m_serverName;
     std::uint16_t m_port;
     mutable std::mutex m_clientsMutex;
     std::unordered_map<std::string, std::shared_ptr<WebSocketClient>> m_clients;
+    // Every open connection, including ones replaced by a newer login that
+    // have not closed yet, so frames are matched without scanning m_clients.
+    std::map<ConnectionHandle, std::shared_ptr<WebSocketClient>, std::owner_less<ConnectionHandle>> m_clientsByHandle;
     UserManager& m_userManager;
     MessageHandler m_messageHandler;
+    mutable std::mutex m_settingsMutex;
+    TransportConfig m_transport;
+    RateLimitConfig m_rateLimit;
+    std::atomic<RateLimitPenalty> m_rateLimitPenalty;
+    RateLimitStats m_rateLimitStats;
+    std::uint64_t m_loggedRateLimitEvents = 0;
+    OfflineQueue m_offlineQueue;
+    std::uint64_t m_loggedOfflineEvents = 0;
+    std::unique_ptr<CandidateBatcher> m_candidateBatcher;
+    AdminServer m_adminServer;
+    CaptureConfig m_captureConfig;
+    TraceCapture m_traceCapture;
+    CallTracer m_callTracer;
     std::unique_ptr<asio::steady_timer> m_cleanupTimer;
+    std::unique_ptr<asio::steady_timer> m_offlinePurgeTimer;
     std::unique_ptr<asio::signal_set> m_signals;
+    std::unique_ptr<asio::signal_set> m_reloadSignals;
     std::atomic_bool m_listening{false};
 };
@@ -25,3 +25,4 @@ WsMsg WsMsg::fromJsonString(const std::string& jsonString)
 WsMsg WsMsg::createErrorNotFoundMsg(const std::string& receiver) { return {"error", "not found recv id", "server", receiver}; }
 WsMsg WsMsg::createOfflineMsg(const std::string& receiver) { return {"error", "The controlled end may not be online", "server", receiver}; }
 WsMsg WsMsg::createErrorPwdMsg(const std::string& receiver) { return {"error", "The controlled end may not be online", "server", receiver}; }
+WsMsg WsMsg::createRateLimitedMsg(const std::string& receiver) { return {"error", "rate limit exceeded", "server", receiver}; }
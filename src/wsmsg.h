@@ -23,6 +23,7 @@ public:
     static WsMsg createErrorNotFoundMsg(const std::string& receiver);
     static WsMsg createOfflineMsg(const std::string& receiver);
     static WsMsg createErrorPwdMsg(const std::string& receiver);
+    static WsMsg createRateLimitedMsg(const std::string& receiver);
 
 private:
     std::string m_type;